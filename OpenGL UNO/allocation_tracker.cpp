@@ -0,0 +1,165 @@
+// Global operator new and delete that count heap allocations per thread, see
+// headers/allocation_tracker.h. Compiled out unless UNO_TRACK_ALLOCATIONS is
+// defined, release builds keep the standard allocator untouched.
+#ifdef UNO_TRACK_ALLOCATIONS
+
+#include "headers/allocation_tracker.h"
+
+#include <new>
+#include <cstdlib>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace
+{
+	// Plain integers, a thread_local with a constructor could allocate on first use
+	thread_local unsigned long long allocationCount = 0;
+	thread_local unsigned long long allocationBytes = 0;
+
+	void* countedAllocate(std::size_t size)
+	{
+		allocationCount++;
+		allocationBytes += size;
+		return std::malloc(size > 0 ? size : 1);
+	}
+
+#ifdef __cpp_aligned_new
+	// Over-aligned types in C++17 come through the align_val_t overloads. Their
+	// blocks have to go back through the matching aligned free, on Windows
+	// _aligned_malloc memory cannot be released with free.
+	void* countedAllocateAligned(std::size_t size, std::align_val_t alignment)
+	{
+		allocationCount++;
+		allocationBytes += size;
+		std::size_t bytes = size > 0 ? size : 1;
+		std::size_t align = (std::size_t)alignment;
+#ifdef _WIN32
+		return _aligned_malloc(bytes, align);
+#else
+		if (align < sizeof(void*))
+			align = sizeof(void*);
+		void* pointer = nullptr;
+		if (posix_memalign(&pointer, align, bytes) != 0)
+			return nullptr;
+		return pointer;
+#endif
+	}
+	void freeAligned(void* pointer)
+	{
+#ifdef _WIN32
+		_aligned_free(pointer);
+#else
+		std::free(pointer);
+#endif
+	}
+#endif
+}
+
+AllocationCounters threadAllocations()
+{
+	AllocationCounters counters;
+	counters.allocations = allocationCount;
+	counters.bytes = allocationBytes;
+	return counters;
+}
+
+void* operator new(std::size_t size)
+{
+	void* pointer = countedAllocate(size);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+void* operator new[](std::size_t size)
+{
+	void* pointer = countedAllocate(size);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAllocate(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+	std::free(pointer);
+}
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+	std::free(pointer);
+}
+
+#ifdef __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	void* pointer = countedAllocateAligned(size, alignment);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	void* pointer = countedAllocateAligned(size, alignment);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return countedAllocateAligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return countedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+	freeAligned(pointer);
+}
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+	freeAligned(pointer);
+}
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+	freeAligned(pointer);
+}
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+	freeAligned(pointer);
+}
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	freeAligned(pointer);
+}
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	freeAligned(pointer);
+}
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <iostream>
+
+// Heap allocations counted by the global operator new in allocation_tracker.cpp.
+// Define UNO_TRACK_ALLOCATIONS to replace operator new, Debug builds do. Without
+// it the counters stay at zero and FrameAllocations prints nothing.
+// -------------------------------------------------------------------------------
+struct AllocationCounters
+{
+	unsigned long long allocations = 0;
+	unsigned long long bytes = 0;
+};
+
+#ifdef UNO_TRACK_ALLOCATIONS
+// Allocations made by the calling thread since it started
+AllocationCounters threadAllocations();
+#else
+inline AllocationCounters threadAllocations()
+{
+	return AllocationCounters();
+}
+#endif
+
+// Allocations per frame on the calling thread. The first frames load and warm
+// up caches, steady state counts start after them and should stay at zero.
+// ---------------------------------------------------------------------------
+class FrameAllocations
+{
+public:
+	FrameAllocations(unsigned int warmupFrames = 30)
+		: warmup(warmupFrames), frames(0), steadyFrames(0), steadyAllocations(0), steadyBytes(0),
+		mostInOneFrame(0), firstAllocatingFrame(-1)
+	{
+	}
+
+	void beginFrame()
+	{
+		frameStart = threadAllocations();
+	}
+	void endFrame()
+	{
+		AllocationCounters now = threadAllocations();
+		unsigned long long allocations = now.allocations - frameStart.allocations;
+		frames++;
+		if (frames <= warmup)
+			return;
+		steadyFrames++;
+		steadyAllocations += allocations;
+		steadyBytes += now.bytes - frameStart.bytes;
+		if (allocations > mostInOneFrame)
+			mostInOneFrame = allocations;
+		if (allocations > 0 && firstAllocatingFrame < 0)
+			firstAllocatingFrame = (int)frames - 1;
+	}
+
+	void print(const char* label) const
+	{
+#ifdef UNO_TRACK_ALLOCATIONS
+		std::cout << "Allocations on the " << label << " thread: " << steadyAllocations << " (" << steadyBytes << " bytes) in "
+			<< steadyFrames << " frames after " << warmup << " warmup frames";
+		if (steadyAllocations > 0)
+			std::cout << ", up to " << mostInOneFrame << " per frame from frame " << firstAllocatingFrame;
+		std::cout << std::endl;
+#else
+		(void)label;
+#endif
+	}
+
+private:
+	unsigned int warmup;
+	unsigned int frames;
+	unsigned int steadyFrames;
+	unsigned long long steadyAllocations;
+	unsigned long long steadyBytes;
+	unsigned long long mostInOneFrame;
+	int firstAllocatingFrame;
+	AllocationCounters frameStart;
+};
+
+#endif
@@ -0,0 +1,474 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include "chunk.h"
+#include "frustum.h"
+#include "render_queue.h"
+#include "mipmap.h"
+#include "transforms.h"
+#include "job_system.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <iostream>
+
+// CPU benchmarks run from the command line, no GL context required
+// ----------------------------------------------------------------
+inline double benchmarkSeconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Greedy meshing throughput on a hilly multi-material terrain
+// -----------------------------------------------------------
+inline int runMeshingBenchmark()
+{
+	const int worldSize = 256;
+	const int maxHeight = 48;
+	ChunkWorld world;
+	unsigned long long solidBlocks = 0;
+	for (int z = 0; z < worldSize; z++)
+	{
+		for (int x = 0; x < worldSize; x++)
+		{
+			int height = 8 + (int)(20.0 * (1.0 + std::sin(x * 0.07) * std::cos(z * 0.05))) + ((x * 7 + z * 13) % 5);
+			if (height > maxHeight)
+				height = maxHeight;
+			for (int y = 0; y < height; y++)
+			{
+				// Surface layer differs so quads cannot merge through everything
+				world.setBlock(x, y, z, y + 1 == height ? (BlockID)2 : BLOCK_COBBLE);
+				solidBlocks++;
+			}
+		}
+	}
+
+	ChunkMesh mesh;
+	unsigned long long quads = 0;
+	unsigned long long chunksMeshed = 0;
+	const int passes = 5;
+	auto start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; pass++)
+	{
+		quads = 0;
+		for (Chunk* chunk : world.chunkList)
+		{
+			greedyMeshChunk(world, *chunk, mesh);
+			quads += mesh.quadCount();
+			chunksMeshed++;
+		}
+	}
+	double seconds = benchmarkSeconds(start);
+
+	std::cout << "Meshing benchmark: " << world.size() << " chunks, " << solidBlocks << " blocks" << std::endl;
+	std::cout << "  " << chunksMeshed / seconds << " chunks/s (" << seconds * 1000.0 / chunksMeshed << " ms per chunk)" << std::endl;
+	std::cout << "  " << quads * 2 << " triangles vs " << solidBlocks * 12 << " for one cube per block" << std::endl;
+	return 0;
+}
+
+// Frustum culling throughput, SIMD path against the scalar reference
+// ------------------------------------------------------------------
+inline int runCullingBenchmark()
+{
+	const char* simdName = UNO_SIMD_NAME;
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1920.0f / 1080.0f, 0.1f, 500.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(100.0f, 0.0f, 100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum = Frustum::fromMatrix(projection * view);
+
+	std::cout << "Culling benchmark (" << simdName << ")" << std::endl;
+	const unsigned int boxCounts[] = { 10000, 100000, 1000000 };
+	for (unsigned int boxCount : boxCounts)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+		std::uniform_real_distribution<float> extent(0.5f, 16.0f);
+		AABBList boxes;
+		for (unsigned int i = 0; i < boxCount; i++)
+		{
+			glm::vec3 min(position(random), position(random) * 0.1f, position(random));
+			boxes.add(min, min + glm::vec3(extent(random), extent(random), extent(random)));
+		}
+
+		std::vector<unsigned int> visible, reference;
+		visible.reserve(boxes.paddedSize());
+		reference.reserve(boxes.paddedSize());
+		const unsigned int iterations = 100000000 / boxCount;
+
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < iterations; i++)
+			cullAABBs(frustum, boxes, visible);
+		double simdSeconds = benchmarkSeconds(start);
+
+		start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < iterations; i++)
+			cullAABBsScalar(frustum, boxes, reference);
+		double scalarSeconds = benchmarkSeconds(start);
+
+		double tested = (double)boxCount * iterations;
+		std::cout << "  " << boxCount << " boxes: " << tested / simdSeconds / 1.0e6 << " M boxes/s " << simdName << ", "
+			<< tested / scalarSeconds / 1.0e6 << " M boxes/s scalar, " << visible.size() << " visible"
+			<< (visible == reference ? "" : " (MISMATCH)") << std::endl;
+	}
+	return 0;
+}
+
+// Render queue sort plus submission walk at one million packets per frame
+// -----------------------------------------------------------------------
+inline int runRenderQueueBenchmark()
+{
+	const unsigned int packetCount = 1000000;
+	const unsigned int frames = 20;
+	DrawList list(packetCount);
+	RenderQueue queue;
+
+	// Packet fields are fixed, only the submission order is shuffled per frame
+	std::mt19937 random(42);
+	std::vector<uint64_t> packets(packetCount);
+	for (unsigned int i = 0; i < packetCount; i++)
+	{
+		packets[i] = SortKey::make(random() % 2, random() % 8, random() % 64, random() % 1024,
+			SortKey::depth((float)(random() % 10000), 10000.0f));
+	}
+
+	double submitSeconds = 0.0, sortSeconds = 0.0, walkSeconds = 0.0;
+	unsigned int sortedChanges = 0;
+	bool ordered = true;
+	for (unsigned int frame = 0; frame < frames; frame++)
+	{
+		std::shuffle(packets.begin(), packets.end(), random);
+
+		auto start = std::chrono::steady_clock::now();
+		list.clear();
+		for (unsigned int i = 0; i < packetCount; i++)
+			list.submit(packets[i]);
+		submitSeconds += benchmarkSeconds(start);
+
+		start = std::chrono::steady_clock::now();
+		list.sort();
+		sortSeconds += benchmarkSeconds(start);
+
+		start = std::chrono::steady_clock::now();
+		sortedChanges = queue.countStateChanges(list);
+		walkSeconds += benchmarkSeconds(start);
+
+		for (unsigned int i = 1; i < list.size() && ordered; i++)
+			ordered = list.sortedKeys()[i - 1] <= list.sortedKeys()[i];
+	}
+
+	// State changes the same packets would cost in submission order
+	list.clear();
+	for (unsigned int i = 0; i < packetCount; i++)
+		list.submit(packets[i]);
+	unsigned int unsortedChanges = queue.countStateChanges(list);
+
+	std::cout << "Render queue benchmark: " << packetCount << " packets, " << frames << " frames" << std::endl;
+	std::cout << "  submit " << submitSeconds * 1000.0 / frames << " ms, sort " << sortSeconds * 1000.0 / frames
+		<< " ms, walk " << walkSeconds * 1000.0 / frames << " ms per frame" << (ordered ? "" : " (NOT SORTED)") << std::endl;
+	std::cout << "  " << sortedChanges << " state changes sorted vs " << unsortedChanges << " unsorted" << std::endl;
+	return 0;
+}
+
+// Model matrix composition at one million objects, the SIMD kernels
+// against building each matrix with glm::translate, mat4_cast and scale
+// ----------------------------------------------------------------------
+inline int runTransformBenchmark()
+{
+	const char* simdName = UNO_SIMD_NAME;
+	const unsigned int objectCount = 1000000;
+	const unsigned int passes = 20;
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+	TransformList transforms;
+	transforms.reserve(objectCount);
+	for (unsigned int i = 0; i < objectCount; i++)
+	{
+		glm::quat rotation = glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+		transforms.add(glm::vec3(position(random), position(random), position(random)), rotation,
+			glm::vec3(scale(random), scale(random), scale(random)));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int pass = 0; pass < passes; pass++)
+	{
+		transforms.markAllDirty();
+		transforms.update();
+	}
+	double simdSeconds = benchmarkSeconds(start);
+
+	std::vector<glm::mat4> reference(objectCount);
+	start = std::chrono::steady_clock::now();
+	for (unsigned int pass = 0; pass < passes; pass++)
+		for (unsigned int i = 0; i < objectCount; i++)
+			reference[i] = transforms.composeReference(i);
+	double scalarSeconds = benchmarkSeconds(start);
+
+	float maxError = 0.0f;
+	for (unsigned int i = 0; i < objectCount; i++)
+		for (int column = 0; column < 4; column++)
+			for (int row = 0; row < 4; row++)
+				maxError = std::max(maxError, std::abs(transforms.matrix(i)[column][row] - reference[i][column][row]));
+
+	// A mostly static scene, one object in a hundred moves per frame
+	const unsigned int moving = objectCount / 100;
+	start = std::chrono::steady_clock::now();
+	for (unsigned int pass = 0; pass < passes; pass++)
+	{
+		for (unsigned int i = 0; i < moving; i++)
+		{
+			unsigned int index = (unsigned int)(random() % objectCount);
+			transforms.setPosition(index, transforms.position(index) + glm::vec3(0.0f, 0.01f, 0.0f));
+		}
+		transforms.update();
+	}
+	double sparseSeconds = benchmarkSeconds(start);
+
+	double composed = (double)objectCount * passes;
+	std::cout << "Transform benchmark (" << simdName << "), " << objectCount << " objects" << std::endl;
+	std::cout << "  " << composed / simdSeconds / 1.0e6 << " M matrices/s " << simdName << ", "
+		<< composed / scalarSeconds / 1.0e6 << " M matrices/s glm, max difference " << maxError << std::endl;
+	std::cout << "  " << moving << " moving: " << sparseSeconds * 1000.0 / passes << " ms per update vs "
+		<< simdSeconds * 1000.0 / passes << " ms recomposing everything" << std::endl;
+	return 0;
+}
+
+// Mip chain generation throughput, SIMD filters against the scalar reference
+// --------------------------------------------------------------------------
+inline int runMipmapBenchmark()
+{
+	const char* simdName = UNO_SIMD_NAME;
+	// Smooth gradients with noise on top, like a photographic texture
+	const int size = 2048;
+	const unsigned int repeats = 3;
+	Image base;
+	base.width = base.height = size;
+	base.channels = 4;
+	base.pixels.resize((size_t)size * size * 4);
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<int> noise(-24, 24);
+	for (int y = 0; y < size; y++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			unsigned char* texel = &base.pixels[((size_t)y * size + x) * 4];
+			int values[4] = { x * 255 / size, y * 255 / size, ((x ^ y) & 255), 255 - ((x + y) & 127) };
+			for (int c = 0; c < 4; c++)
+			{
+				int value = values[c] + noise(random);
+				texel[c] = (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+			}
+		}
+	}
+
+	std::cout << "Mipmap benchmark (" << simdName << "), " << size << "x" << size << " sRGB source" << std::endl;
+	const MipFilter filters[] = { MIP_FILTER_BOX, MIP_FILTER_KAISER };
+	const char* filterNames[] = { "box", "Kaiser" };
+	LinearImage linearBase;
+	imageToLinear(base, true, linearBase);
+	double megapixels = (double)size * size * repeats / 1000000.0;
+	for (MipFilter filter : filters)
+	{
+		// Filtering alone, float level to float level
+		double filterSeconds[2] = { 0.0, 0.0 };
+		for (unsigned int path = 0; path < 2; path++)
+		{
+			LinearImage current, next, scratch;
+			for (unsigned int repeat = 0; repeat < repeats; repeat++)
+			{
+				current = linearBase;
+				auto start = std::chrono::steady_clock::now();
+				while (current.width > 1 || current.height > 1)
+				{
+					downsampleLinear(current, next, scratch, filter, path == 0);
+					std::swap(current, next);
+				}
+				filterSeconds[path] += benchmarkSeconds(start);
+			}
+		}
+
+		// Whole chain including sRGB conversion and quantization
+		std::vector<Image> simdLevels, scalarLevels;
+		double seconds[2] = { 0.0, 0.0 };
+		for (unsigned int repeat = 0; repeat < repeats; repeat++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			generateMipChain(base, filter, true, simdLevels, true);
+			seconds[0] += benchmarkSeconds(start);
+
+			start = std::chrono::steady_clock::now();
+			generateMipChain(base, filter, true, scalarLevels, false);
+			seconds[1] += benchmarkSeconds(start);
+		}
+
+		// Float summation order matches, results should agree to the byte
+		int maxDifference = 0;
+		for (size_t level = 0; level < simdLevels.size(); level++)
+		{
+			for (size_t i = 0; i < simdLevels[level].pixels.size(); i++)
+			{
+				int difference = std::abs((int)simdLevels[level].pixels[i] - (int)scalarLevels[level].pixels[i]);
+				maxDifference = difference > maxDifference ? difference : maxDifference;
+			}
+		}
+
+		std::cout << "  " << filterNames[filter] << " filter: " << megapixels / filterSeconds[0] << " MP/s " << simdName
+			<< " vs " << megapixels / filterSeconds[1] << " MP/s scalar (" << filterSeconds[1] / filterSeconds[0] << "x)" << std::endl;
+		std::cout << "  " << filterNames[filter] << " chain:  " << megapixels / seconds[0] << " MP/s " << simdName
+			<< " vs " << megapixels / seconds[1] << " MP/s scalar (" << seconds[1] / seconds[0] << "x), "
+			<< simdLevels.size() << " levels, max difference " << maxDifference << std::endl;
+	}
+	return 0;
+}
+
+// A job queued under newer jobs that finish first must still run once the
+// owner's queue has wrapped around. Reused job records used to overwrite it,
+// so it never ran and the final wait hangs if that comes back.
+// -------------------------------------------------------------------------
+inline bool checkQueuedJobSurvivesWrap()
+{
+	JobSystem jobs(1);
+	JobFunction count = [](void* data, unsigned int, unsigned int)
+	{
+		(*(unsigned int*)data)++;
+	};
+	unsigned int heldRuns = 0, newerRuns = 0;
+	JobCounter held;
+	jobs.run(held, count, &heldRuns);
+	for (unsigned int i = 0; i < WorkStealingQueue::CAPACITY; i++)
+	{
+		JobCounter newer;
+		jobs.run(newer, count, &newerRuns);
+		jobs.wait(newer);
+	}
+	bool stillQueued = heldRuns == 0 && !held.done();
+	jobs.wait(held);
+	return stillQueued && heldRuns == 1 && newerRuns == WorkStealingQueue::CAPACITY;
+}
+
+// Job system scaling on a synthetic frame: uneven per-object animation,
+// then matrix composition that depends on it, with independent culling
+// batches running alongside. Each thread count must match the 1 thread result.
+// ---------------------------------------------------------------------------
+struct CullBatch
+{
+	const Frustum* frustum;
+	AABBList bounds;
+	std::vector<unsigned int> visible;
+};
+
+inline int runJobBenchmark()
+{
+	if (!checkQueuedJobSurvivesWrap())
+	{
+		std::cout << "ERROR::JOBS::QUEUED_JOB_LOST" << std::endl;
+		return -1;
+	}
+
+	const unsigned int objectCount = 1u << 18;
+	const unsigned int batchCount = 64;
+	const unsigned int boxesPerBatch = 8192;
+	const unsigned int frames = 30;
+	const unsigned int warmupFrames = 3;
+
+	std::mt19937 random(99);
+	std::uniform_real_distribution<float> coordinate(-200.0f, 200.0f);
+	std::vector<float> phases(objectCount);
+	for (float& phase : phases)
+		phase = coordinate(random);
+	glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f)
+		* glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(1.0f, 8.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum = Frustum::fromMatrix(viewProjection);
+	std::vector<CullBatch> batches(batchCount);
+	for (CullBatch& batch : batches)
+	{
+		batch.frustum = &frustum;
+		for (unsigned int i = 0; i < boxesPerBatch; i++)
+		{
+			glm::vec3 min(coordinate(random), coordinate(random) * 0.1f, coordinate(random));
+			batch.bounds.add(min, min + glm::vec3(1.0f));
+		}
+		batch.visible.reserve(batch.bounds.paddedSize());
+	}
+	std::vector<glm::vec3> positions(objectCount);
+	std::vector<glm::mat4> matrices(objectCount);
+
+	// Cost varies from 1 to 48 steps per object so equal splits would not balance
+	auto animate = [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+		{
+			unsigned int steps = 1 + (i * 2654435761u >> 26) % 48;
+			float value = phases[i];
+			glm::vec3 position(0.0f);
+			for (unsigned int step = 0; step < steps; step++)
+			{
+				position += glm::vec3(std::sin(value), std::cos(value * 0.5f), std::sin(value * 0.25f));
+				value += 0.37f;
+			}
+			positions[i] = position;
+		}
+	};
+	auto compose = [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+			matrices[i] = glm::rotate(glm::translate(glm::mat4(1.0f), positions[i]), phases[i], glm::vec3(0.0f, 1.0f, 0.0f));
+	};
+	JobFunction cull = [](void* data, unsigned int, unsigned int)
+	{
+		CullBatch& batch = *(CullBatch*)data;
+		cullAABBs(*batch.frustum, batch.bounds, batch.visible);
+	};
+
+	unsigned int maxThreads = std::thread::hardware_concurrency();
+	if (maxThreads == 0)
+		maxThreads = 1;
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int threads = 1; threads < maxThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(maxThreads);
+
+	std::cout << "Job benchmark: " << objectCount << " objects, " << batchCount << " culling batches, " << frames << " frames" << std::endl;
+	double singleThreadMs = 0.0;
+	double referenceChecksum = 0.0;
+	for (unsigned int threads : threadCounts)
+	{
+		JobSystem jobs(threads);
+		double seconds = 0.0;
+		for (unsigned int frame = 0; frame < warmupFrames + frames; frame++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			JobCounter animation, culling, composition;
+			jobs.parallelFor(animation, objectCount, animate);
+			for (CullBatch& batch : batches)
+				jobs.run(culling, cull, &batch);
+			jobs.wait(animation);
+			jobs.parallelFor(composition, objectCount, compose);
+			jobs.wait(composition);
+			jobs.wait(culling);
+			if (frame >= warmupFrames)
+				seconds += benchmarkSeconds(start);
+		}
+
+		double checksum = 0.0;
+		for (unsigned int i = 0; i < objectCount; i++)
+			checksum += matrices[i][3][0] + matrices[i][3][1] + matrices[i][3][2] + matrices[i][0][0];
+		for (const CullBatch& batch : batches)
+			checksum += (double)batch.visible.size();
+		double frameMs = seconds * 1000.0 / frames;
+		if (threads == 1)
+		{
+			singleThreadMs = frameMs;
+			referenceChecksum = checksum;
+		}
+		std::cout << "  " << threads << (threads == 1 ? " thread: " : " threads: ") << frameMs << " ms/frame, "
+			<< singleThreadMs / frameMs << "x speedup, " << 100.0 * singleThreadMs / frameMs / threads << "% efficiency"
+			<< (checksum == referenceChecksum ? "" : " (MISMATCH)") << std::endl;
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "frustum.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+
+enum ProjectionMode
+{
+	// glm::perspective with a finite far plane and depth from -1 to 1
+	PROJECTION_STANDARD,
+	// Infinite far plane with depth running from 1 at the near plane to 0 at
+	// infinity. Needs glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE), a depth
+	// clear of 0 and GL_GREATER, and wants a floating point depth buffer.
+	PROJECTION_REVERSED_INFINITE
+};
+
+// Fly camera. The simulation moves position() once per tick, rendering calls
+// update() with the tick interpolation factor once per frame. View, projection
+// and frustum are rebuilt only when their inputs changed since the last update.
+// -----------------------------------------------------------------------------
+class Camera
+{
+public:
+	Camera(const glm::vec3& startPosition, float startYaw, float startPitch, float startFov)
+		: current(startPosition), previous(startPosition), eye(startPosition), worldUp(0.0f, 1.0f, 0.0f),
+		yawDegrees(0.0f), pitchDegrees(0.0f), fovDegrees(startFov),
+		width(800), height(600), zNear(0.1f), zFar(100.0f), mode(PROJECTION_STANDARD),
+		viewDirty(true), projectionDirty(true)
+	{
+		orient(startYaw, startPitch);
+	}
+
+	// Simulated position
+	// ------------------
+	const glm::vec3& position() const
+	{
+		return current;
+	}
+	void setPosition(const glm::vec3& position)
+	{
+		current = position;
+	}
+	void move(const glm::vec3& offset)
+	{
+		current += offset;
+	}
+	// Call before each simulation tick, rendering interpolates from here
+	void beginTick()
+	{
+		previous = current;
+	}
+	// Jump without interpolating from the old position
+	void teleport(const glm::vec3& position)
+	{
+		current = previous = position;
+	}
+
+	// Orientation in degrees, pitch is kept short of straight up or down
+	// -------------------------------------------------------------------
+	float yaw() const
+	{
+		return yawDegrees;
+	}
+	float pitch() const
+	{
+		return pitchDegrees;
+	}
+	void setOrientation(float newYaw, float newPitch)
+	{
+		if (newYaw != yawDegrees || newPitch != pitchDegrees)
+			orient(newYaw, newPitch);
+	}
+	void rotate(float yawOffset, float pitchOffset)
+	{
+		setOrientation(yawDegrees + yawOffset, pitchDegrees + pitchOffset);
+	}
+	const glm::vec3& front() const
+	{
+		return forward;
+	}
+	const glm::vec3& right() const
+	{
+		return sideways;
+	}
+	const glm::vec3& up() const
+	{
+		return worldUp;
+	}
+
+	// Projection
+	// ----------
+	float fov() const
+	{
+		return fovDegrees;
+	}
+	void setFov(float degrees)
+	{
+		if (degrees < 1.0f)
+			degrees = 1.0f;
+		if (degrees > 90.0f)
+			degrees = 90.0f;
+		if (degrees != fovDegrees)
+		{
+			fovDegrees = degrees;
+			projectionDirty = true;
+		}
+	}
+	// Framebuffer size the camera renders to, a minimised window reports 0 and is ignored
+	void setViewport(int viewportWidth, int viewportHeight)
+	{
+		if (viewportWidth <= 0 || viewportHeight <= 0 || (viewportWidth == width && viewportHeight == height))
+			return;
+		width = viewportWidth;
+		height = viewportHeight;
+		projectionDirty = true;
+	}
+	int viewportWidth() const
+	{
+		return width;
+	}
+	int viewportHeight() const
+	{
+		return height;
+	}
+	// The far plane is ignored by the infinite projection
+	void setClipRange(float nearPlane, float farPlane)
+	{
+		zNear = nearPlane;
+		zFar = farPlane;
+		projectionDirty = true;
+	}
+	void setProjectionMode(ProjectionMode projectionMode)
+	{
+		if (projectionMode != mode)
+		{
+			mode = projectionMode;
+			projectionDirty = true;
+		}
+	}
+	ProjectionMode projectionMode() const
+	{
+		return mode;
+	}
+
+	// Place the eye between the last two ticks and rebuild whatever changed.
+	// Returns true if the matrices differ from the previous update.
+	// ----------------------------------------------------------------------
+	bool update(float alpha)
+	{
+		glm::vec3 eyePosition = previous + (current - previous) * alpha;
+		if (eyePosition != eye)
+		{
+			eye = eyePosition;
+			viewDirty = true;
+		}
+		if (!viewDirty && !projectionDirty)
+			return false;
+		if (viewDirty)
+			viewMatrix = glm::lookAt(eye, eye + forward, worldUp);
+		if (projectionDirty)
+			projectionMatrix = buildProjection();
+		viewProjectionMatrix = projectionMatrix * viewMatrix;
+		cullingFrustum = Frustum::fromMatrix(viewProjectionMatrix, mode == PROJECTION_REVERSED_INFINITE);
+		viewDirty = projectionDirty = false;
+		return true;
+	}
+
+	// Results of the last update
+	// --------------------------
+	const glm::vec3& eyePosition() const
+	{
+		return eye;
+	}
+	const glm::mat4& view() const
+	{
+		return viewMatrix;
+	}
+	const glm::mat4& projection() const
+	{
+		return projectionMatrix;
+	}
+	const glm::mat4& viewProjection() const
+	{
+		return viewProjectionMatrix;
+	}
+	const Frustum& frustum() const
+	{
+		return cullingFrustum;
+	}
+
+private:
+	glm::vec3 current;
+	glm::vec3 previous;
+	glm::vec3 eye;
+	glm::vec3 forward;
+	glm::vec3 sideways;
+	const glm::vec3 worldUp;
+	float yawDegrees;
+	float pitchDegrees;
+	float fovDegrees;
+
+	int width;
+	int height;
+	float zNear;
+	float zFar;
+	ProjectionMode mode;
+
+	bool viewDirty;
+	bool projectionDirty;
+	glm::mat4 viewMatrix;
+	glm::mat4 projectionMatrix;
+	glm::mat4 viewProjectionMatrix;
+	Frustum cullingFrustum;
+
+	void orient(float newYaw, float newPitch)
+	{
+		if (newPitch > 89.0f)
+			newPitch = 89.0f;
+		if (newPitch < -89.0f)
+			newPitch = -89.0f;
+		yawDegrees = newYaw;
+		pitchDegrees = newPitch;
+		glm::vec3 direction;
+		direction.x = cos(glm::radians(yawDegrees)) * cos(glm::radians(pitchDegrees));
+		direction.y = sin(glm::radians(pitchDegrees));
+		direction.z = sin(glm::radians(yawDegrees)) * cos(glm::radians(pitchDegrees));
+		forward = glm::normalize(direction);
+		sideways = glm::normalize(glm::cross(forward, worldUp));
+		viewDirty = true;
+	}
+	glm::mat4 buildProjection() const
+	{
+		float aspect = (float)width / (float)height;
+		if (mode == PROJECTION_STANDARD)
+			return glm::perspective(glm::radians(fovDegrees), aspect, zNear, zFar);
+		// Clip z is the near distance and w the view depth, so depth = near / depth
+		float focal = 1.0f / tan(glm::radians(fovDegrees) * 0.5f);
+		glm::mat4 projection(0.0f);
+		projection[0][0] = focal / aspect;
+		projection[1][1] = focal;
+		projection[2][3] = -1.0f;
+		projection[3][2] = zNear;
+		return projection;
+	}
+};
+
+#endif
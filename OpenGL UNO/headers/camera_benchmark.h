@@ -0,0 +1,220 @@
+#ifndef CAMERA_BENCHMARK_H
+#define CAMERA_BENCHMARK_H
+
+#include "camera_path.h"
+#include "gpu_timer.h"
+#include "frame_timer.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+// Distribution of a per-frame measurement in milliseconds
+// -------------------------------------------------------
+struct PercentileSummary
+{
+	double p50 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+	double mean = 0.0;
+};
+
+// Nearest rank percentiles, the input is sorted in place
+inline PercentileSummary summarize(std::vector<double>& samples)
+{
+	PercentileSummary summary;
+	if (samples.empty())
+		return summary;
+	std::sort(samples.begin(), samples.end());
+	size_t count = samples.size();
+	auto rank = [&](double percentile) {
+		size_t index = (size_t)(percentile / 100.0 * count + 0.999999);
+		return samples[index == 0 ? 0 : (index > count ? count : index) - 1];
+	};
+	summary.p50 = rank(50.0);
+	summary.p95 = rank(95.0);
+	summary.p99 = rank(99.0);
+	summary.max = samples.back();
+	double total = 0.0;
+	for (double sample : samples)
+		total += sample;
+	summary.mean = total / count;
+	return summary;
+}
+
+// Plays a camera path over a fixed number of frames and records the wall,
+// CPU and GPU time of each. The camera depends only on the frame index, so
+// every run renders the same images and runs can be compared across builds.
+// A few warmup frames at the first keyframe absorb driver first-use costs
+// and are not recorded.
+// -------------------------------------------------------------------------
+class CameraBenchmark
+{
+public:
+	CameraBenchmark(const CameraPath& cameraPath, int frameCount, int warmupFrames = 10)
+		: path(cameraPath), frames(frameCount > 1 ? frameCount : 2), warmup(warmupFrames), current(-1),
+		runStart(0.0), frameStart(0.0), runEnd(0.0)
+	{
+		frameMs.reserve(frames);
+		cpuMs.reserve(frames);
+		gpuMs.assign(frames, -1.0);
+	}
+
+	// Frames to render including the warmup
+	int totalFrames() const
+	{
+		return warmup + frames;
+	}
+	// Camera for a rendered frame, the path is spread evenly over the recorded frames
+	CameraKeyframe cameraAt(int frame) const
+	{
+		int recorded = frame > warmup ? frame - warmup : 0;
+		return path.sample(path.duration() * recorded / (frames - 1));
+	}
+
+	// Call before the first GL command of the frame
+	void beginFrame(int frame)
+	{
+		current = frame - warmup;
+		if (current < 0)
+			return;
+		double now = monotonicSeconds();
+		if (current == 0)
+			runStart = now;
+		else
+			frameMs.push_back((now - frameStart) * 1000.0);
+		frameStart = now;
+
+		collectGpuTimes(false);
+		// Every query still in flight means the GPU is far behind, wait for the oldest
+		if (!gpuTimer.begin(current))
+		{
+			collectGpuTimes(true);
+			gpuTimer.begin(current);
+		}
+	}
+	// Call once the frame has been submitted, before swapping or waiting on the GPU
+	void endFrame()
+	{
+		if (current < 0)
+			return;
+		gpuTimer.end();
+		cpuMs.push_back((monotonicSeconds() - frameStart) * 1000.0);
+	}
+	// Call after the last frame has been presented
+	void finish()
+	{
+		if (current < 0)
+			return;
+		runEnd = monotonicSeconds();
+		frameMs.push_back((runEnd - frameStart) * 1000.0);
+		while (collectGpuTimes(true))
+			;
+	}
+
+	// Print the summary and write it as JSON, returns false if the file could not be written
+	// -------------------------------------------------------------------------------------
+	bool write(const char* outputPath, unsigned int gridSize, int worldSize, const char* renderMode)
+	{
+		std::vector<double> gpuSamples;
+		for (double sample : gpuMs)
+			if (sample >= 0.0)
+				gpuSamples.push_back(sample);
+		int recorded = (int)frameMs.size();
+		double seconds = runEnd - runStart;
+		double fps = seconds > 0.0 ? recorded / seconds : 0.0;
+		PercentileSummary frame = summarize(frameMs);
+		PercentileSummary cpu = summarize(cpuMs);
+		PercentileSummary gpu = summarize(gpuSamples);
+
+		std::cout << "Camera path: " << gridSize << "x" << gridSize << " grid, " << renderMode << ", "
+			<< recorded << " frames, " << fps << " fps" << std::endl;
+		printSummary("frame", frame);
+		printSummary("cpu", cpu);
+		printSummary("gpu", gpu);
+
+		std::ofstream file(outputPath, std::ios::trunc);
+		if (!file)
+		{
+			std::cout << "ERROR::BENCHMARK::WRITE_FAILED " << outputPath << std::endl;
+			return false;
+		}
+		const char* renderer = (const char*)glGetString(GL_RENDERER);
+		file << "{\n";
+		file << "\t\"benchmark\": \"camera_path\",\n";
+		file << "\t\"renderer\": \"" << escape(renderer ? renderer : "") << "\",\n";
+		file << "\t\"grid\": " << gridSize << ",\n";
+		file << "\t\"world\": " << worldSize << ",\n";
+		file << "\t\"render_mode\": \"" << escape(renderMode) << "\",\n";
+		file << "\t\"frames\": " << recorded << ",\n";
+		file << "\t\"gpu_frames\": " << gpuSamples.size() << ",\n";
+		file << "\t\"seconds\": " << seconds << ",\n";
+		file << "\t\"fps\": " << fps << ",\n";
+		writeSummary(file, "frame_ms", frame, false);
+		writeSummary(file, "cpu_ms", cpu, false);
+		writeSummary(file, "gpu_ms", gpu, true);
+		file << "}\n";
+		return (bool)file;
+	}
+
+private:
+	CameraPath path;
+	int frames;
+	int warmup;
+	// Recorded frame in progress, negative during warmup
+	int current;
+	GpuTimer gpuTimer;
+	std::vector<double> frameMs;
+	std::vector<double> cpuMs;
+	// Indexed by frame, -1 until the query result arrives
+	std::vector<double> gpuMs;
+	double runStart;
+	double frameStart;
+	double runEnd;
+
+	bool collectGpuTimes(bool wait)
+	{
+		int frame;
+		double milliseconds;
+		bool collected = false;
+		while (gpuTimer.collect(frame, milliseconds, wait))
+		{
+			if (frame >= 0 && frame < frames)
+				gpuMs[frame] = milliseconds;
+			collected = true;
+			// Waiting is only needed for the oldest query, the rest follow it
+			wait = false;
+		}
+		return collected;
+	}
+
+	static void printSummary(const char* label, const PercentileSummary& summary)
+	{
+		std::cout << "  " << label << " ms: p50 " << summary.p50 << ", p95 " << summary.p95 << ", p99 " << summary.p99
+			<< ", max " << summary.max << ", mean " << summary.mean << std::endl;
+	}
+	static void writeSummary(std::ofstream& file, const char* name, const PercentileSummary& summary, bool last)
+	{
+		file << "\t\"" << name << "\": { \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99
+			<< ", \"max\": " << summary.max << ", \"mean\": " << summary.mean << " }" << (last ? "\n" : ",\n");
+	}
+	static std::string escape(const char* text)
+	{
+		std::string escaped;
+		for (const char* c = text; *c; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				escaped += '\\';
+			if ((unsigned char)*c >= 0x20)
+				escaped += *c;
+		}
+		return escaped;
+	}
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Camera state at a point in time, angles in degrees like the input callbacks
+// --------------------------------------------------------------------------
+struct CameraKeyframe
+{
+	float time;
+	glm::vec3 position;
+	float yaw;
+	float pitch;
+	float fov;
+};
+
+// Keyframed camera motion, sampled by time with linear interpolation.
+// Keyframes must be added in increasing time order.
+// -------------------------------------------------------------------
+class CameraPath
+{
+public:
+	void add(float time, const glm::vec3& position, float yaw, float pitch, float fov)
+	{
+		CameraKeyframe key = { time, position, yaw, pitch, fov };
+		keys.push_back(key);
+	}
+
+	float duration() const
+	{
+		return keys.empty() ? 0.0f : keys.back().time;
+	}
+
+	// Clamps to the first and last keyframe outside the path
+	CameraKeyframe sample(float time) const
+	{
+		if (keys.empty())
+			return CameraKeyframe{ 0.0f, glm::vec3(0.0f), -90.0f, 0.0f, 45.0f };
+		if (time <= keys.front().time)
+			return keys.front();
+		for (size_t i = 1; i < keys.size(); i++)
+		{
+			const CameraKeyframe& a = keys[i - 1];
+			const CameraKeyframe& b = keys[i];
+			if (time > b.time)
+				continue;
+			float t = b.time > a.time ? (time - a.time) / (b.time - a.time) : 1.0f;
+			CameraKeyframe key;
+			key.time = time;
+			key.position = glm::mix(a.position, b.position, t);
+			key.yaw = a.yaw + (b.yaw - a.yaw) * t;
+			key.pitch = a.pitch + (b.pitch - a.pitch) * t;
+			key.fov = a.fov + (b.fov - a.fov) * t;
+			return key;
+		}
+		return keys.back();
+	}
+
+	// Fly over a square floor of extent x extent starting at the origin: a low
+	// pass along one edge, a diagonal sweep toward the far corner, then a
+	// climb. The climb scales with extent so the last two keyframes see most
+	// of the floor at any grid size, the projection has no far plane to clip it.
+	// ---------------------------------------------------------------------------
+	static CameraPath flyover(float extent)
+	{
+		CameraPath path;
+		float low = 2.0f;
+		float high = extent * 0.75f + 10.0f;
+		path.add(0.0f,  glm::vec3(-4.0f, low, -4.0f), 45.0f, -15.0f, 45.0f);
+		path.add(4.0f,  glm::vec3(extent * 0.5f, low, -4.0f), 90.0f, -20.0f, 45.0f);
+		path.add(8.0f,  glm::vec3(extent * 0.5f, low * 2.0f, extent * 0.5f), 135.0f, -25.0f, 60.0f);
+		path.add(12.0f, glm::vec3(extent + 4.0f, low, extent + 4.0f), 225.0f, -15.0f, 45.0f);
+		path.add(16.0f, glm::vec3(extent + 4.0f, high, extent + 4.0f), 225.0f, -45.0f, 60.0f);
+		path.add(20.0f, glm::vec3(extent * 0.5f, high, -4.0f), 90.0f, -60.0f, 75.0f);
+		return path;
+	}
+
+private:
+	std::vector<CameraKeyframe> keys;
+};
+
+#endif
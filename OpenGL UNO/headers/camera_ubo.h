@@ -0,0 +1,105 @@
+#ifndef CAMERA_UBO_H
+#define CAMERA_UBO_H
+
+#include "shader.h"
+#include "gl_state.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstring>
+
+// Camera block laid out to match std140 in the shaders
+// ----------------------------------------------------
+struct CameraBlock
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProjection;
+	glm::vec4 position;
+};
+
+// Uniform buffer shared by every program through CAMERA_BLOCK_BINDING.
+// Each frame writes the next region of a ring, waiting on that region's
+// fence only if the GPU has not finished reading it yet.
+// ---------------------------------------------------------------------
+class CameraUniformBuffer
+{
+public:
+	// Buffer ID
+	unsigned int ID;
+
+	CameraUniformBuffer(unsigned int regionCount = 3)
+		: fences(regionCount, (GLsync)0), current(0)
+	{
+		int alignment = 256;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		stride = (unsigned int)((sizeof(CameraBlock) + alignment - 1) / alignment * alignment);
+
+		glGenBuffers(1, &ID);
+		glState().bindBuffer(GL_UNIFORM_BUFFER, ID);
+		glBufferData(GL_UNIFORM_BUFFER, stride * regionCount, NULL, GL_DYNAMIC_DRAW);
+	}
+	~CameraUniformBuffer()
+	{
+		for (GLsync fence : fences)
+			if (fence)
+				glDeleteSync(fence);
+		glDeleteBuffers(1, &ID);
+	}
+	CameraUniformBuffer(const CameraUniformBuffer&) = delete;
+	CameraUniformBuffer& operator=(const CameraUniformBuffer&) = delete;
+
+	// Write this frame's camera into the next region and bind it
+	// ----------------------------------------------------------
+	void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position)
+	{
+		current = (current + 1) % fences.size();
+		waitForRegion(current);
+
+		CameraBlock block;
+		block.view = view;
+		block.projection = projection;
+		block.viewProjection = projection * view;
+		block.position = glm::vec4(position, 1.0f);
+
+		GLintptr offset = (GLintptr)current * stride;
+		glState().bindBuffer(GL_UNIFORM_BUFFER, ID);
+		void* region = glMapBufferRange(GL_UNIFORM_BUFFER, offset, sizeof(CameraBlock),
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (region)
+		{
+			std::memcpy(region, &block, sizeof(CameraBlock));
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+		}
+		glState().bindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, ID, offset, sizeof(CameraBlock));
+	}
+	// Mark the current region as in flight, call after the frame's draws
+	// -------------------------------------------------------------------
+	void fence()
+	{
+		if (fences[current])
+			glDeleteSync(fences[current]);
+		fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+private:
+	std::vector<GLsync> fences;
+	unsigned int stride;
+	unsigned int current;
+
+	void waitForRegion(unsigned int region)
+	{
+		GLsync fence = fences[region];
+		if (!fence)
+			return;
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		while (result == GL_TIMEOUT_EXPIRED)
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		glDeleteSync(fence);
+		fences[region] = (GLsync)0;
+	}
+};
+
+#endif
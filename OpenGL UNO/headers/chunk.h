@@ -0,0 +1,398 @@
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include "gl_state.h"
+#include "pool_allocator.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <unordered_map>
+
+// Blocks per chunk along each axis
+const int CHUNK_SIZE = 32;
+const int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+// Block types, 0 is empty space
+typedef unsigned char BlockID;
+const BlockID BLOCK_AIR    = 0;
+const BlockID BLOCK_COBBLE = 1;
+
+// Position (3), texture coordinate (2) and texture array layer (1)
+const int CHUNK_VERTEX_FLOATS = 6;
+
+// Chunk coordinate <-> block coordinate helpers, rounding towards -infinity
+inline int chunkCoord(int block)
+{
+	return block >= 0 ? block / CHUNK_SIZE : (block - CHUNK_SIZE + 1) / CHUNK_SIZE;
+}
+inline int chunkLocal(int block)
+{
+	return block - chunkCoord(block) * CHUNK_SIZE;
+}
+
+// Interleaved vertex data and indices of one chunk
+// ------------------------------------------------
+struct ChunkMesh
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+
+	void clear()
+	{
+		vertices.clear();
+		indices.clear();
+	}
+	unsigned int quadCount() const
+	{
+		return (unsigned int)(indices.size() / 6);
+	}
+};
+
+// GPU copy of a chunk mesh, drawn with a single glDrawElements
+// ------------------------------------------------------------
+class ChunkMeshBuffer
+{
+public:
+	unsigned int VAO, VBO, EBO;
+	unsigned int indexCount;
+
+	ChunkMeshBuffer()
+		: indexCount(0)
+	{
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+		glState().bindVertexArray(VAO);
+		glState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+		glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		// Position attribute
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, CHUNK_VERTEX_FLOATS * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		// Texture attribute
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, CHUNK_VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		// Material layer attribute, after the instance matrix locations
+		glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, CHUNK_VERTEX_FLOATS * sizeof(float), (void*)(5 * sizeof(float)));
+		glEnableVertexAttribArray(6);
+		glState().bindVertexArray(0);
+	}
+	~ChunkMeshBuffer()
+	{
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+	}
+	ChunkMeshBuffer(const ChunkMeshBuffer&) = delete;
+	ChunkMeshBuffer& operator=(const ChunkMeshBuffer&) = delete;
+
+	void upload(const ChunkMesh& mesh)
+	{
+		glState().bindVertexArray(VAO);
+		glState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(float), mesh.vertices.data(), GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
+		indexCount = (unsigned int)mesh.indices.size();
+	}
+	void draw() const
+	{
+		glState().bindVertexArray(VAO);
+		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+	}
+};
+
+// 32x32x32 blocks stored as a flat x-fastest array of block IDs
+// -------------------------------------------------------------
+class Chunk
+{
+public:
+	glm::ivec3 coord;
+	BlockID blocks[CHUNK_VOLUME];
+	bool dirty;
+	std::unique_ptr<ChunkMeshBuffer> gpuMesh;
+
+	Chunk(const glm::ivec3& chunkCoordinate)
+		: coord(chunkCoordinate), dirty(true)
+	{
+		std::memset(blocks, BLOCK_AIR, sizeof(blocks));
+	}
+
+	static int index(int x, int y, int z)
+	{
+		return x + CHUNK_SIZE * (y + CHUNK_SIZE * z);
+	}
+	BlockID get(int x, int y, int z) const
+	{
+		return blocks[index(x, y, z)];
+	}
+	void set(int x, int y, int z, BlockID block)
+	{
+		blocks[index(x, y, z)] = block;
+		dirty = true;
+	}
+	// Lowest corner of the chunk in block coordinates
+	glm::ivec3 origin() const
+	{
+		return glm::ivec3(coord.x * CHUNK_SIZE, coord.y * CHUNK_SIZE, coord.z * CHUNK_SIZE);
+	}
+};
+
+// Sparse grid of chunks addressed by chunk coordinate. Chunks come from a
+// pool, not one heap block each.
+// -----------------------------------------------------------------------
+class ChunkWorld
+{
+public:
+	std::vector<Chunk*> chunkList;
+	// Texture array layer of each block type
+	float blockLayers[256];
+
+	ChunkWorld()
+	{
+		for (int i = 0; i < 256; i++)
+			blockLayers[i] = 0.0f;
+	}
+	~ChunkWorld()
+	{
+		for (Chunk* chunk : chunkList)
+			chunkPool.destroy(chunk);
+	}
+	ChunkWorld(const ChunkWorld&) = delete;
+	ChunkWorld& operator=(const ChunkWorld&) = delete;
+	void setBlockLayer(BlockID block, unsigned int layer)
+	{
+		blockLayers[block] = (float)layer;
+	}
+
+	Chunk* find(int cx, int cy, int cz) const
+	{
+		auto found = chunks.find(key(cx, cy, cz));
+		return found == chunks.end() ? nullptr : found->second;
+	}
+	Chunk* getOrCreate(int cx, int cy, int cz)
+	{
+		Chunk*& slot = chunks[key(cx, cy, cz)];
+		if (!slot)
+		{
+			slot = chunkPool.create(glm::ivec3(cx, cy, cz));
+			chunkList.push_back(slot);
+		}
+		return slot;
+	}
+	BlockID getBlock(int x, int y, int z) const
+	{
+		Chunk* chunk = find(chunkCoord(x), chunkCoord(y), chunkCoord(z));
+		return chunk ? chunk->get(chunkLocal(x), chunkLocal(y), chunkLocal(z)) : BLOCK_AIR;
+	}
+	void setBlock(int x, int y, int z, BlockID block)
+	{
+		int lx = chunkLocal(x), ly = chunkLocal(y), lz = chunkLocal(z);
+		getOrCreate(chunkCoord(x), chunkCoord(y), chunkCoord(z))->set(lx, ly, lz, block);
+		// Faces on the shared border of a neighbor may appear or disappear
+		markNeighborDirty(x, y, z, lx == 0 ? -1 : (lx == CHUNK_SIZE - 1 ? 1 : 0), 0, 0);
+		markNeighborDirty(x, y, z, 0, ly == 0 ? -1 : (ly == CHUNK_SIZE - 1 ? 1 : 0), 0);
+		markNeighborDirty(x, y, z, 0, 0, lz == 0 ? -1 : (lz == CHUNK_SIZE - 1 ? 1 : 0));
+	}
+	// Fill a one block thick floor spanning [0, sizeX) x [0, sizeZ) at height y
+	void fillFloor(int sizeX, int sizeZ, int y, BlockID block)
+	{
+		for (int z = 0; z < sizeZ; z++)
+		{
+			for (int x = 0; x < sizeX; x++)
+			{
+				Chunk* chunk = getOrCreate(chunkCoord(x), chunkCoord(y), chunkCoord(z));
+				chunk->set(chunkLocal(x), chunkLocal(y), chunkLocal(z), block);
+			}
+		}
+	}
+	size_t size() const
+	{
+		return chunkList.size();
+	}
+
+private:
+	ObjectPool<Chunk> chunkPool;
+	std::unordered_map<unsigned long long, Chunk*> chunks;
+
+	static unsigned long long key(int cx, int cy, int cz)
+	{
+		// 21 bits per axis
+		return ((unsigned long long)(cx & 0x1FFFFF) << 42) | ((unsigned long long)(cy & 0x1FFFFF) << 21) | (unsigned long long)(cz & 0x1FFFFF);
+	}
+	void markNeighborDirty(int x, int y, int z, int dx, int dy, int dz)
+	{
+		if (dx == 0 && dy == 0 && dz == 0)
+			return;
+		Chunk* neighbor = find(chunkCoord(x + dx), chunkCoord(y + dy), chunkCoord(z + dz));
+		if (neighbor)
+			neighbor->dirty = true;
+	}
+};
+
+// Build a chunk mesh with hidden-face removal and greedy quad merging.
+// Faces are emitted only for this chunk's own blocks, neighboring
+// chunks are read to hide faces on the shared border.
+// ---------------------------------------------------------------------
+inline void greedyMeshChunk(const ChunkWorld& world, const Chunk& chunk, ChunkMesh& mesh)
+{
+	mesh.clear();
+	const glm::ivec3 base = chunk.origin();
+	const int cx = chunk.coord.x, cy = chunk.coord.y, cz = chunk.coord.z;
+	// Neighbors indexed by axis, [0] below and [1] above
+	const Chunk* neighbors[3][2] = {
+		{ world.find(cx - 1, cy, cz), world.find(cx + 1, cy, cz) },
+		{ world.find(cx, cy - 1, cz), world.find(cx, cy + 1, cz) },
+		{ world.find(cx, cy, cz - 1), world.find(cx, cy, cz + 1) }
+	};
+
+	// Signed block IDs, positive faces point along +d and negative along -d
+	int mask[CHUNK_SIZE * CHUNK_SIZE];
+
+	for (int d = 0; d < 3; d++)
+	{
+		const int u = (d + 1) % 3;
+		const int v = (d + 2) % 3;
+		int x[3] = { 0, 0, 0 };
+		int step[3] = { 0, 0, 0 };
+		step[d] = 1;
+
+		for (x[d] = -1; x[d] < CHUNK_SIZE; x[d]++)
+		{
+			// Compute the face mask of the slice between x[d] and x[d] + 1
+			int n = 0;
+			for (x[v] = 0; x[v] < CHUNK_SIZE; x[v]++)
+			{
+				for (x[u] = 0; x[u] < CHUNK_SIZE; x[u]++, n++)
+				{
+					BlockID a, b;
+					if (x[d] >= 0)
+						a = chunk.get(x[0], x[1], x[2]);
+					else
+					{
+						const Chunk* below = neighbors[d][0];
+						int y[3] = { x[0], x[1], x[2] };
+						y[d] = CHUNK_SIZE - 1;
+						a = below ? below->get(y[0], y[1], y[2]) : BLOCK_AIR;
+					}
+					if (x[d] < CHUNK_SIZE - 1)
+						b = chunk.get(x[0] + step[0], x[1] + step[1], x[2] + step[2]);
+					else
+					{
+						const Chunk* above = neighbors[d][1];
+						int y[3] = { x[0], x[1], x[2] };
+						y[d] = 0;
+						b = above ? above->get(y[0], y[1], y[2]) : BLOCK_AIR;
+					}
+
+					if (a != BLOCK_AIR && b == BLOCK_AIR && x[d] >= 0)
+						mask[n] = a;
+					else if (b != BLOCK_AIR && a == BLOCK_AIR && x[d] < CHUNK_SIZE - 1)
+						mask[n] = -b;
+					else
+						mask[n] = 0;
+				}
+			}
+
+			// Merge equal mask entries into maximal rectangles
+			n = 0;
+			for (int j = 0; j < CHUNK_SIZE; j++)
+			{
+				for (int i = 0; i < CHUNK_SIZE;)
+				{
+					int face = mask[n];
+					if (face == 0)
+					{
+						i++;
+						n++;
+						continue;
+					}
+					int width = 1;
+					while (i + width < CHUNK_SIZE && mask[n + width] == face)
+						width++;
+					int height = 1;
+					for (; j + height < CHUNK_SIZE; height++)
+					{
+						bool rowMatches = true;
+						for (int k = 0; k < width; k++)
+						{
+							if (mask[n + k + height * CHUNK_SIZE] != face)
+							{
+								rowMatches = false;
+								break;
+							}
+						}
+						if (!rowMatches)
+							break;
+					}
+
+					// Quad corners in world space, blocks are unit cubes centred on integer coordinates
+					float p[3];
+					p[d] = (float)(x[d] + 1);
+					p[u] = (float)i;
+					p[v] = (float)j;
+					float du[3] = { 0.0f, 0.0f, 0.0f };
+					float dv[3] = { 0.0f, 0.0f, 0.0f };
+					du[u] = (float)width;
+					dv[v] = (float)height;
+
+					unsigned int first = (unsigned int)(mesh.vertices.size() / CHUNK_VERTEX_FLOATS);
+					float layer = world.blockLayers[face > 0 ? face : -face];
+					const float corners[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+					for (int q = 0; q < 4; q++)
+					{
+						float s = corners[q][0], t = corners[q][1];
+						mesh.vertices.push_back(base.x + p[0] + du[0] * s + dv[0] * t - 0.5f);
+						mesh.vertices.push_back(base.y + p[1] + du[1] * s + dv[1] * t - 0.5f);
+						mesh.vertices.push_back(base.z + p[2] + du[2] * s + dv[2] * t - 0.5f);
+						// Texture repeats once per block across the merged quad
+						mesh.vertices.push_back(s * width);
+						mesh.vertices.push_back(t * height);
+						mesh.vertices.push_back(layer);
+					}
+					// Counter-clockwise seen from the side the face points to
+					if (face > 0)
+					{
+						unsigned int quad[6] = { first, first + 1, first + 2, first, first + 2, first + 3 };
+						mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+					}
+					else
+					{
+						unsigned int quad[6] = { first, first + 2, first + 1, first, first + 3, first + 2 };
+						mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+					}
+
+					// Clear the merged area
+					for (int h = 0; h < height; h++)
+						for (int k = 0; k < width; k++)
+							mask[n + k + h * CHUNK_SIZE] = 0;
+					i += width;
+					n += width;
+				}
+			}
+		}
+	}
+}
+
+// Remesh and upload every dirty chunk, returns the number rebuilt
+// ---------------------------------------------------------------
+inline unsigned int updateChunkMeshes(ChunkWorld& world, ChunkMesh& scratch)
+{
+	unsigned int rebuilt = 0;
+	for (Chunk* chunk : world.chunkList)
+	{
+		if (!chunk->dirty)
+			continue;
+		greedyMeshChunk(world, *chunk, scratch);
+		if (!chunk->gpuMesh)
+			chunk->gpuMesh.reset(new ChunkMeshBuffer());
+		chunk->gpuMesh->upload(scratch);
+		chunk->dirty = false;
+		rebuilt++;
+	}
+	return rebuilt;
+}
+
+#endif
@@ -0,0 +1,311 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include "gl_state.h"
+#include "gl_extensions.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Cooked texture container
+// ------------------------
+// header | level table | level data, each level holds every layer back to back
+// and starts on a 16 byte boundary. All fields are little endian.
+enum CookedFormat
+{
+	COOKED_RGBA8 = 0,
+	COOKED_BC1 = 1,
+	COOKED_BC3 = 2,
+	// Understood by the loader, the cooker does not encode it
+	COOKED_BC7 = 3
+};
+
+const char COOKED_MAGIC[4] = { 'U', 'N', 'O', 'T' };
+const uint32_t COOKED_VERSION = 1;
+
+struct CookedTextureHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t layers;
+	uint32_t levels;
+	uint32_t reserved;
+};
+
+struct CookedLevel
+{
+	uint64_t offset;
+	uint64_t size;
+	uint32_t width;
+	uint32_t height;
+};
+
+// Bytes in one layer of a mip level
+inline uint64_t cookedLevelSize(uint32_t format, uint32_t width, uint32_t height)
+{
+	if (format == COOKED_RGBA8)
+		return (uint64_t)width * height * 4;
+	uint64_t blocks = (uint64_t)((width + 3) / 4) * ((height + 3) / 4);
+	return blocks * (format == COOKED_BC1 ? 8 : 16);
+}
+
+// Read only memory mapping of a whole file
+// ----------------------------------------
+class MappedFile
+{
+public:
+	MappedFile()
+		: bytes(nullptr), length(0)
+#ifdef _WIN32
+		, file(INVALID_HANDLE_VALUE), mapping(NULL)
+#endif
+	{
+	}
+	~MappedFile()
+	{
+		close();
+	}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const char* path)
+	{
+		close();
+#ifdef _WIN32
+		file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			close();
+			return false;
+		}
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL)
+		{
+			close();
+			return false;
+		}
+		bytes = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		length = (size_t)fileSize.QuadPart;
+#else
+		int descriptor = ::open(path, O_RDONLY);
+		if (descriptor < 0)
+			return false;
+		struct stat info;
+		if (fstat(descriptor, &info) != 0 || info.st_size == 0)
+		{
+			::close(descriptor);
+			return false;
+		}
+		void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		// The mapping stays valid after the descriptor is closed
+		::close(descriptor);
+		if (view == MAP_FAILED)
+			return false;
+		bytes = (const unsigned char*)view;
+		length = (size_t)info.st_size;
+#endif
+		if (!bytes)
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+	void close()
+	{
+#ifdef _WIN32
+		if (bytes)
+			UnmapViewOfFile(bytes);
+		if (mapping != NULL)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		mapping = NULL;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (bytes)
+			munmap((void*)bytes, length);
+#endif
+		bytes = nullptr;
+		length = 0;
+	}
+
+	const unsigned char* data() const
+	{
+		return bytes;
+	}
+	size_t size() const
+	{
+		return length;
+	}
+
+private:
+	const unsigned char* bytes;
+	size_t length;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#endif
+};
+
+// Memory mapped cooked texture, uploaded straight from the mapping
+// ----------------------------------------------------------------
+class CookedTexture
+{
+public:
+	CookedTexture()
+		: header(nullptr), levels(nullptr)
+	{
+	}
+
+	// Map and validate a container, returns false if it is missing or malformed
+	bool open(const char* path)
+	{
+		header = nullptr;
+		levels = nullptr;
+		if (!file.open(path))
+			return false;
+
+		if (file.size() < sizeof(CookedTextureHeader))
+			return invalid(path);
+		const CookedTextureHeader* candidate = (const CookedTextureHeader*)file.data();
+		if (std::memcmp(candidate->magic, COOKED_MAGIC, 4) != 0 || candidate->version != COOKED_VERSION
+			|| candidate->format > COOKED_BC7 || candidate->levels == 0 || candidate->levels > 32 || candidate->layers == 0)
+			return invalid(path);
+		if (file.size() < sizeof(CookedTextureHeader) + candidate->levels * sizeof(CookedLevel))
+			return invalid(path);
+
+		const CookedLevel* table = (const CookedLevel*)(file.data() + sizeof(CookedTextureHeader));
+		for (uint32_t level = 0; level < candidate->levels; level++)
+		{
+			const CookedLevel& entry = table[level];
+			uint64_t expected = cookedLevelSize(candidate->format, entry.width, entry.height) * candidate->layers;
+			if (entry.size != expected || entry.offset > file.size() || entry.size > file.size() - entry.offset)
+				return invalid(path);
+		}
+		header = candidate;
+		levels = table;
+		return true;
+	}
+
+	bool valid() const
+	{
+		return header != nullptr;
+	}
+	bool supported() const
+	{
+		if (!header)
+			return false;
+		if (header->format == COOKED_BC1 || header->format == COOKED_BC3)
+			return glExtensions().textureCompressionS3TC;
+		if (header->format == COOKED_BC7)
+			return glExtensions().textureCompressionBPTC;
+		return true;
+	}
+	const CookedTextureHeader& info() const
+	{
+		return *header;
+	}
+	size_t fileSize() const
+	{
+		return file.size();
+	}
+	const CookedLevel& levelInfo(uint32_t level) const
+	{
+		return levels[level];
+	}
+	// One layer of a mip level inside the mapping
+	const unsigned char* layerData(uint32_t level, uint32_t layer) const
+	{
+		const CookedLevel& entry = levels[level];
+		return file.data() + entry.offset + layer * (entry.size / header->layers);
+	}
+
+	// Create a GL_TEXTURE_2D (single layer) or GL_TEXTURE_2D_ARRAY with every
+	// cooked mip level, returns 0 if the format is not supported by the driver
+	// ------------------------------------------------------------------------
+	unsigned int createTexture(GLenum target, GLenum wrap, GLenum minFilter, GLenum magFilter) const
+	{
+		if (!supported() || (target == GL_TEXTURE_2D && header->layers != 1))
+			return 0;
+
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glState().bindTexture(0, target, texture);
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, minFilter);
+		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, magFilter);
+		glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, (GLint)header->levels - 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		GLenum internalFormat = glInternalFormat();
+		for (uint32_t level = 0; level < header->levels; level++)
+		{
+			const CookedLevel& entry = levels[level];
+			const void* pixels = file.data() + entry.offset;
+			if (header->format == COOKED_RGBA8)
+			{
+				if (target == GL_TEXTURE_2D)
+					glTexImage2D(target, level, GL_RGBA8, entry.width, entry.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+				else
+					glTexImage3D(target, level, GL_RGBA8, entry.width, entry.height, header->layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+			}
+			else if (target == GL_TEXTURE_2D)
+				glCompressedTexImage2D(target, level, internalFormat, entry.width, entry.height, 0, (GLsizei)entry.size, pixels);
+			else
+				glCompressedTexImage3D(target, level, internalFormat, entry.width, entry.height, header->layers, 0, (GLsizei)entry.size, pixels);
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		return texture;
+	}
+
+private:
+	MappedFile file;
+	const CookedTextureHeader* header;
+	const CookedLevel* levels;
+
+	GLenum glInternalFormat() const
+	{
+		switch (header->format)
+		{
+		case COOKED_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case COOKED_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case COOKED_BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		default: return GL_RGBA8;
+		}
+	}
+	bool invalid(const char* path)
+	{
+		std::cout << "ERROR::COOKED_TEXTURE::INVALID_FILE " << path << std::endl;
+		file.close();
+		return false;
+	}
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef FILE_CACHE_H
+#define FILE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Generated data that later launches can reuse lives under this directory
+const char* const CACHE_DIRECTORY = "cache";
+
+// Create a directory, doing nothing if it already exists
+inline void makeDirectory(const char* path)
+{
+#ifdef _WIN32
+	_mkdir(path);
+#else
+	mkdir(path, 0755);
+#endif
+}
+
+// FNV-1a over a byte range, chained through seed
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+#endif
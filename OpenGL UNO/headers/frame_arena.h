@@ -0,0 +1,146 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Bump allocator over one preallocated block, for data that lives exactly one
+// frame. Allocating moves an offset, nothing is freed on its own and reset()
+// releases everything at once. Requests that do not fit go to the heap and are
+// freed by the next reset, overflowBytes() says how much the block was short.
+// Not thread safe, give each thread or each frame in flight its own arena.
+// -----------------------------------------------------------------------------
+class LinearArena
+{
+public:
+	LinearArena(size_t capacityBytes = 0)
+		: base(nullptr), capacity(0), offset(0), peak(0), overflow(0)
+	{
+		reserve(capacityBytes);
+	}
+	~LinearArena()
+	{
+		reset();
+		::operator delete(base);
+	}
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	// Replace the block, everything allocated from the old one is released
+	void reserve(size_t capacityBytes)
+	{
+		reset();
+		::operator delete(base);
+		base = capacityBytes > 0 ? (char*)::operator new(capacityBytes) : nullptr;
+		capacity = capacityBytes;
+	}
+
+	void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+	{
+		uintptr_t start = ((uintptr_t)base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t end = (size_t)(start - (uintptr_t)base) + size;
+		if (base && end <= capacity)
+		{
+			offset = end;
+			if (offset > peak)
+				peak = offset;
+			return (void*)start;
+		}
+		overflow += size;
+		overflowBlocks.push_back(::operator new(size));
+		return overflowBlocks.back();
+	}
+	// Uninitialised storage for count objects, which are never destroyed
+	template <typename T>
+	T* allocateArray(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+		return (T*)allocate(count * sizeof(T), alignof(T));
+	}
+
+	void reset()
+	{
+		offset = 0;
+		for (void* block : overflowBlocks)
+			::operator delete(block);
+		overflowBlocks.clear();
+	}
+
+	size_t size() const
+	{
+		return capacity;
+	}
+	size_t used() const
+	{
+		return offset;
+	}
+	// Most bytes in use at once since the arena was created
+	size_t highWater() const
+	{
+		return peak;
+	}
+	// Bytes that did not fit and went to the heap instead
+	size_t overflowBytes() const
+	{
+		return overflow;
+	}
+
+private:
+	char* base;
+	size_t capacity;
+	size_t offset;
+	size_t peak;
+	size_t overflow;
+	std::vector<void*> overflowBlocks;
+};
+
+// STL allocator drawing from a LinearArena. Deallocation does nothing, so
+// containers using it must not outlive the arena's next reset.
+//
+//   std::vector<unsigned int, ArenaAllocator<unsigned int>> visible{ ArenaAllocator<unsigned int>(arena) };
+// ------------------------------------------------------------------------------------------------------
+template <typename T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	ArenaAllocator(LinearArena& source)
+		: arena(&source)
+	{
+	}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other)
+		: arena(other.arena)
+	{
+	}
+
+	T* allocate(size_t count)
+	{
+		return (T*)arena->allocate(count * sizeof(T), alignof(T));
+	}
+	void deallocate(T*, size_t)
+	{
+	}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const
+	{
+		return arena == other.arena;
+	}
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const
+	{
+		return arena != other.arena;
+	}
+
+private:
+	template <typename U>
+	friend class ArenaAllocator;
+	LinearArena* arena;
+};
+
+#endif
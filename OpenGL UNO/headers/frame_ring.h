@@ -0,0 +1,107 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+// Single producer, single consumer ring of preallocated frame slots. With
+// three slots the producer fills one while the consumer works on another and
+// a finished one waits between them. Slots are reused, never copied, and the
+// handoff is a pair of atomic counters. A full or empty ring spins briefly
+// and then backs off, nothing ever takes a lock.
+//
+//   producer: T* slot = ring.beginWrite(); ...; ring.endWrite();
+//   consumer: T* slot = ring.beginRead();  ...; ring.endRead();
+// ---------------------------------------------------------------------------
+template <typename T, unsigned int SLOTS = 3>
+class FrameRing
+{
+public:
+	FrameRing()
+		: written(0), read(0), closed(false)
+	{
+	}
+	FrameRing(const FrameRing&) = delete;
+	FrameRing& operator=(const FrameRing&) = delete;
+
+	static unsigned int slotCount()
+	{
+		return SLOTS;
+	}
+	// Direct slot access for setup before either thread starts
+	T& slot(unsigned int index)
+	{
+		return slots[index];
+	}
+
+	// Wait for a free slot, returns null once the ring is closed
+	T* beginWrite()
+	{
+		unsigned int spins = 0;
+		while (written.load(std::memory_order_relaxed) - read.load(std::memory_order_acquire) >= SLOTS)
+		{
+			if (closed.load(std::memory_order_relaxed))
+				return nullptr;
+			backOff(spins);
+		}
+		return &slots[written.load(std::memory_order_relaxed) % SLOTS];
+	}
+	// Hand the slot to the consumer
+	void endWrite()
+	{
+		written.fetch_add(1, std::memory_order_release);
+	}
+
+	// Wait for a written slot, returns null once the ring is closed and drained
+	T* beginRead()
+	{
+		unsigned int spins = 0;
+		while (written.load(std::memory_order_acquire) == read.load(std::memory_order_relaxed))
+		{
+			if (closed.load(std::memory_order_acquire) && written.load(std::memory_order_acquire) == read.load(std::memory_order_relaxed))
+				return nullptr;
+			backOff(spins);
+		}
+		return &slots[read.load(std::memory_order_relaxed) % SLOTS];
+	}
+	// Return the slot to the producer
+	void endRead()
+	{
+		read.fetch_add(1, std::memory_order_release);
+	}
+
+	// No more slots will be written, the consumer drains what is left
+	void close()
+	{
+		closed.store(true, std::memory_order_release);
+	}
+	// Slots written but not yet read
+	unsigned int pending() const
+	{
+		return written.load(std::memory_order_acquire) - read.load(std::memory_order_acquire);
+	}
+
+private:
+	T slots[SLOTS];
+	// Monotonic slot counters, each written by one side only and kept on
+	// separate cache lines
+	alignas(64) std::atomic<unsigned int> written;
+	alignas(64) std::atomic<unsigned int> read;
+	std::atomic<bool> closed;
+
+	// Spin for short waits, then give the core away. Long waits, such as the
+	// producer waiting out a vsync blocked swap, sleep instead of burning it.
+	static void backOff(unsigned int& spins)
+	{
+		spins++;
+		if (spins < 64)
+			return;
+		if (spins < 256)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+};
+
+#endif
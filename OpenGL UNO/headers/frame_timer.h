@@ -0,0 +1,61 @@
+#ifndef FRAME_TIMER_H
+#define FRAME_TIMER_H
+
+#include <iostream>
+#include <chrono>
+
+// Seconds on a monotonic clock. Unlike glfwGetTime it works without GLFW,
+// which headless runs never initialise.
+inline double monotonicSeconds()
+{
+	static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Averages frame and submission times and prints them once per interval
+// ---------------------------------------------------------------------
+class FrameTimer
+{
+public:
+	FrameTimer(double reportInterval = 1.0)
+		: interval(reportInterval)
+	{
+		reset(0.0);
+	}
+
+	void reset(double now)
+	{
+		windowStart = now;
+		frameCount = 0;
+		frameTime = 0.0;
+		submitTime = 0.0;
+		drawCalls = 0;
+	}
+	// Record one frame, returns true if a report was printed
+	bool frame(double now, double frameSeconds, double submitSeconds, unsigned int draws, const char* label)
+	{
+		frameCount++;
+		frameTime += frameSeconds;
+		submitTime += submitSeconds;
+		drawCalls += draws;
+		if (now - windowStart < interval)
+			return false;
+
+		double frameMs  = frameTime  * 1000.0 / frameCount;
+		double submitMs = submitTime * 1000.0 / frameCount;
+		std::cout << label << ": " << frameMs << " ms/frame (" << (frameMs > 0.0 ? 1000.0 / frameMs : 0.0) << " fps), "
+			<< submitMs << " ms submit, " << drawCalls / frameCount << " draws" << std::endl;
+		reset(now);
+		return true;
+	}
+
+private:
+	double interval;
+	double windowStart;
+	unsigned int frameCount;
+	double frameTime;
+	double submitTime;
+	unsigned long long drawCalls;
+};
+
+#endif
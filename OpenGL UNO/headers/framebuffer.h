@@ -0,0 +1,125 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+
+// Offscreen colour and depth target. Replaces the default framebuffer when
+// there is no window, and gives windowed rendering a floating point depth
+// buffer (GL_DEPTH32F_STENCIL8) that the default framebuffer cannot have.
+// ------------------------------------------------------------------------
+class Framebuffer
+{
+public:
+	unsigned int FBO;
+	int width;
+	int height;
+
+	Framebuffer(int framebufferWidth, int framebufferHeight, GLenum depthStencilFormat = GL_DEPTH24_STENCIL8)
+		: width(framebufferWidth), height(framebufferHeight), depthFormat(depthStencilFormat)
+	{
+		glGenFramebuffers(1, &FBO);
+		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+		glGenRenderbuffers(1, &colorBuffer);
+		glGenRenderbuffers(1, &depthBuffer);
+		allocate();
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE" << std::endl;
+	}
+	~Framebuffer()
+	{
+		glDeleteFramebuffers(1, &FBO);
+		glDeleteRenderbuffers(1, &colorBuffer);
+		glDeleteRenderbuffers(1, &depthBuffer);
+	}
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	// Draw into this target with a matching viewport
+	void bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+		glViewport(0, 0, width, height);
+	}
+
+	// Reallocate both attachments, contents are lost
+	void resize(int framebufferWidth, int framebufferHeight)
+	{
+		if (framebufferWidth <= 0 || framebufferHeight <= 0 || (framebufferWidth == width && framebufferHeight == height))
+			return;
+		width = framebufferWidth;
+		height = framebufferHeight;
+		allocate();
+	}
+
+	// Copy the colour attachment to the window, then draw into this target again
+	void present(int windowWidth, int windowHeight) const
+	{
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	}
+
+	// Read the colour attachment as tightly packed RGB, top row first
+	// ---------------------------------------------------------------
+	void readPixels(std::vector<unsigned char>& pixels) const
+	{
+		pixels.resize((size_t)width * height * 3);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+		// GL rows start at the bottom
+		size_t rowSize = (size_t)width * 3;
+		std::vector<unsigned char> row(rowSize);
+		for (int y = 0; y < height / 2; y++)
+		{
+			unsigned char* top = &pixels[y * rowSize];
+			unsigned char* bottom = &pixels[(height - 1 - y) * rowSize];
+			std::copy(top, top + rowSize, row.begin());
+			std::copy(bottom, bottom + rowSize, top);
+			std::copy(row.begin(), row.end(), bottom);
+		}
+	}
+
+	// Write the colour attachment as a binary PPM
+	bool writePPM(const char* path) const
+	{
+		std::vector<unsigned char> pixels;
+		readPixels(pixels);
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			std::cout << "ERROR::FRAMEBUFFER::WRITE_FAILED " << path << std::endl;
+			return false;
+		}
+		file << "P6\n" << width << " " << height << "\n255\n";
+		file.write((const char*)pixels.data(), pixels.size());
+		return (bool)file;
+	}
+
+private:
+	unsigned int colorBuffer;
+	unsigned int depthBuffer;
+	GLenum depthFormat;
+
+	void allocate()
+	{
+		glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, depthFormat, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	}
+};
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "simd.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <limits>
+#include <cmath>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// View frustum as six inward facing planes (normal.xyz, distance)
+// ---------------------------------------------------------------
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	// Gribb/Hartmann extraction from a projection * view matrix. With
+	// zeroToOneDepth clip depth runs from 0 to w (glClipControl) instead of
+	// -w to w. An infinite far plane comes out with a zero normal and a
+	// positive distance, which every box passes.
+	static Frustum fromMatrix(const glm::mat4& m, bool zeroToOneDepth = false)
+	{
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; i++)
+			rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+		Frustum frustum;
+		frustum.planes[0] = rows[3] + rows[0]; // Left
+		frustum.planes[1] = rows[3] - rows[0]; // Right
+		frustum.planes[2] = rows[3] + rows[1]; // Bottom
+		frustum.planes[3] = rows[3] - rows[1]; // Top
+		frustum.planes[4] = zeroToOneDepth ? rows[2] : rows[3] + rows[2]; // Near, the infinite far plane when depth is reversed
+		frustum.planes[5] = rows[3] - rows[2]; // Far, the near plane when depth is reversed
+		for (int i = 0; i < 6; i++)
+		{
+			glm::vec4& p = frustum.planes[i];
+			float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+			if (length > 0.0f)
+				p = p * (1.0f / length);
+		}
+		return frustum;
+	}
+};
+
+// Axis aligned boxes stored as structure of arrays, padded to 8 lanes
+// -------------------------------------------------------------------
+class AABBList
+{
+public:
+	std::vector<float> minX, minY, minZ;
+	std::vector<float> maxX, maxY, maxZ;
+
+	void clear()
+	{
+		count = 0;
+		resizeLanes(0);
+	}
+	void add(const glm::vec3& min, const glm::vec3& max)
+	{
+		// Overwrite the first padding slot, or grow by a block of 8
+		if (count == minX.size())
+			resizeLanes(count + 8);
+		minX[count] = min.x; minY[count] = min.y; minZ[count] = min.z;
+		maxX[count] = max.x; maxY[count] = max.y; maxZ[count] = max.z;
+		count++;
+	}
+	unsigned int size() const
+	{
+		return (unsigned int)count;
+	}
+	// Number of lanes including NaN padding, always a multiple of 8
+	unsigned int paddedSize() const
+	{
+		return (unsigned int)minX.size();
+	}
+
+private:
+	size_t count = 0;
+
+	void resizeLanes(size_t size)
+	{
+		const float padding = std::numeric_limits<float>::quiet_NaN();
+		minX.resize(size, padding); minY.resize(size, padding); minZ.resize(size, padding);
+		maxX.resize(size, padding); maxY.resize(size, padding); maxZ.resize(size, padding);
+	}
+};
+
+inline unsigned int countTrailingZeros(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+// Append the lanes set in mask, padding lanes are NaN and never set
+inline void appendVisible(unsigned int mask, unsigned int first, unsigned int* visible, unsigned int& visibleCount)
+{
+	while (mask)
+	{
+		visible[visibleCount++] = first + countTrailingZeros(mask);
+		mask &= mask - 1;
+	}
+}
+
+// Scalar reference, also used when no SIMD instruction set is available
+// ---------------------------------------------------------------------
+inline void cullAABBsScalar(const Frustum& frustum, const AABBList& boxes, std::vector<unsigned int>& visible)
+{
+	visible.clear();
+	for (unsigned int i = 0; i < boxes.size(); i++)
+	{
+		bool inside = true;
+		for (int p = 0; p < 6 && inside; p++)
+		{
+			const glm::vec4& plane = frustum.planes[p];
+			// Test the corner furthest along the plane normal
+			float x = plane.x >= 0.0f ? boxes.maxX[i] : boxes.minX[i];
+			float y = plane.y >= 0.0f ? boxes.maxY[i] : boxes.minY[i];
+			float z = plane.z >= 0.0f ? boxes.maxZ[i] : boxes.minZ[i];
+			inside = plane.x * x + plane.y * y + plane.z * z + plane.w >= 0.0f;
+		}
+		if (inside)
+			visible.push_back(i);
+	}
+}
+
+// Write the indices of boxes intersecting the frustum into visible.
+// The furthest corner along each plane is chosen per plane, so the
+// inner loop is only loads, multiplies, adds and a compare.
+// ------------------------------------------------------------------
+inline void cullAABBs(const Frustum& frustum, const AABBList& boxes, std::vector<unsigned int>& visible)
+{
+#if defined(UNO_SIMD_AVX2) || defined(UNO_SIMD_SSE2)
+	visible.resize(boxes.paddedSize());
+	unsigned int visibleCount = 0;
+
+	const float* cornerX[6];
+	const float* cornerY[6];
+	const float* cornerZ[6];
+	for (int p = 0; p < 6; p++)
+	{
+		const glm::vec4& plane = frustum.planes[p];
+		cornerX[p] = plane.x >= 0.0f ? boxes.maxX.data() : boxes.minX.data();
+		cornerY[p] = plane.y >= 0.0f ? boxes.maxY.data() : boxes.minY.data();
+		cornerZ[p] = plane.z >= 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+	}
+
+#if defined(UNO_SIMD_AVX2)
+	__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++)
+	{
+		planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+	}
+	const __m256 zero = _mm256_setzero_ps();
+	for (unsigned int i = 0; i < boxes.paddedSize(); i += 8)
+	{
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m256 d = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(planeX[p], _mm256_loadu_ps(cornerX[p] + i)), _mm256_mul_ps(planeY[p], _mm256_loadu_ps(cornerY[p] + i))),
+				_mm256_add_ps(_mm256_mul_ps(planeZ[p], _mm256_loadu_ps(cornerZ[p] + i)), planeW[p]));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+		}
+		appendVisible((unsigned int)_mm256_movemask_ps(inside), i, visible.data(), visibleCount);
+	}
+#else
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++)
+	{
+		planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+	const __m128 zero = _mm_setzero_ps();
+	for (unsigned int i = 0; i < boxes.paddedSize(); i += 4)
+	{
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(planeX[p], _mm_loadu_ps(cornerX[p] + i)), _mm_mul_ps(planeY[p], _mm_loadu_ps(cornerY[p] + i))),
+				_mm_add_ps(_mm_mul_ps(planeZ[p], _mm_loadu_ps(cornerZ[p] + i)), planeW[p]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(d, zero));
+		}
+		appendVisible((unsigned int)_mm_movemask_ps(inside), i, visible.data(), visibleCount);
+	}
+#endif
+	visible.resize(visibleCount);
+#else
+	cullAABBsScalar(frustum, boxes, visible);
+#endif
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef GAME_LOOP_H
+#define GAME_LOOP_H
+
+// Fixed rate simulation clock. Real time is accumulated in double
+// precision and consumed in whole ticks, the remainder becomes the
+// interpolation factor between the last two simulated states.
+// ----------------------------------------------------------------
+class FixedTimestep
+{
+public:
+	FixedTimestep(double ticksPerSecond = 60.0, unsigned int maxTicksPerFrame = 8)
+		: tickLength(1.0 / ticksPerSecond), maxTicks(maxTicksPerFrame)
+	{
+		start(0.0);
+	}
+
+	void start(double now)
+	{
+		lastTime = now;
+		accumulator = 0.0;
+		tickCount = 0;
+	}
+	// Returns how many ticks to simulate for the real time elapsed since the last call
+	unsigned int advance(double now)
+	{
+		double elapsed = now - lastTime;
+		lastTime = now;
+		// After a long stall drop time instead of trying to catch up all at once
+		double maxElapsed = tickLength * maxTicks;
+		if (elapsed > maxElapsed)
+			elapsed = maxElapsed;
+		if (elapsed < 0.0)
+			elapsed = 0.0;
+		accumulator += elapsed;
+
+		unsigned int ticks = (unsigned int)(accumulator / tickLength);
+		accumulator -= ticks * tickLength;
+		tickCount += ticks;
+		return ticks;
+	}
+
+	// Seconds per tick, the simulation always steps by exactly this much
+	double tickSeconds() const
+	{
+		return tickLength;
+	}
+	// Time of the latest simulated state
+	double simulationTime() const
+	{
+		return tickCount * tickLength;
+	}
+	unsigned long long ticks() const
+	{
+		return tickCount;
+	}
+	// Fraction of a tick between the previous and current state to render at
+	float alpha() const
+	{
+		return (float)(accumulator / tickLength);
+	}
+
+private:
+	double tickLength;
+	unsigned int maxTicks;
+	double lastTime;
+	double accumulator;
+	unsigned long long tickCount;
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+// Enums the GL 3.3 core loader does not define
+// --------------------------------------------
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_ZERO_TO_ONE
+#define GL_ZERO_TO_ONE 0x935F
+#endif
+
+// Entry points the GL 3.3 core loader does not load
+typedef void (APIENTRYP GLProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP GLGetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP GLProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP GLMaxShaderCompilerThreadsProc)(GLuint count);
+typedef void (APIENTRYP GLClipControlProc)(GLenum origin, GLenum depth);
+
+// Features beyond the GL 3.3 core profile the glad loader was generated for.
+// The context's version and extension list are read once by load(), right
+// after gladLoadGLLoader and with the same loader, which also resolves the
+// entry points of each feature. Flags stay false and pointers null until
+// then, and a feature whose entry points are missing reports false.
+// --------------------------------------------------------------------------
+class GLExtensions
+{
+public:
+	// Context version as major * 10 + minor, 33 for GL 3.3
+	int version = 0;
+	bool textureCompressionS3TC = false;
+	// Core since GL 4.2
+	bool textureCompressionBPTC = false;
+	// Core since GL 4.1
+	bool programBinaries = false;
+	GLProgramBinaryProc programBinary = nullptr;
+	GLGetProgramBinaryProc getProgramBinary = nullptr;
+	GLProgramParameteriProc programParameteri = nullptr;
+	// KHR_parallel_shader_compile
+	bool parallelShaderCompile = false;
+	GLMaxShaderCompilerThreadsProc maxShaderCompilerThreads = nullptr;
+	// Core since GL 4.5
+	bool clipControl = false;
+	GLClipControlProc clipControlDepth = nullptr;
+
+	void load(GLADloadproc loader)
+	{
+		int major = 0, minor = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		version = major * 10 + minor;
+		textureCompressionBPTC = version >= 42;
+		programBinaries = version >= 41;
+		clipControl = version >= 45;
+
+		int count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (int i = 0; i < count; i++)
+		{
+			const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+			if (!name)
+				continue;
+			if (std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0)
+				textureCompressionS3TC = true;
+			else if (std::strcmp(name, "GL_ARB_texture_compression_bptc") == 0)
+				textureCompressionBPTC = true;
+			else if (std::strcmp(name, "GL_ARB_get_program_binary") == 0)
+				programBinaries = true;
+			else if (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0)
+				parallelShaderCompile = true;
+			else if (std::strcmp(name, "GL_ARB_clip_control") == 0)
+				clipControl = true;
+		}
+
+		if (programBinaries)
+		{
+			programBinary = (GLProgramBinaryProc)loader("glProgramBinary");
+			getProgramBinary = (GLGetProgramBinaryProc)loader("glGetProgramBinary");
+			programParameteri = (GLProgramParameteriProc)loader("glProgramParameteri");
+			programBinaries = programBinary && getProgramBinary && programParameteri;
+		}
+		if (parallelShaderCompile)
+		{
+			maxShaderCompilerThreads = (GLMaxShaderCompilerThreadsProc)loader("glMaxShaderCompilerThreadsKHR");
+			parallelShaderCompile = maxShaderCompilerThreads != nullptr;
+		}
+		if (clipControl)
+		{
+			clipControlDepth = (GLClipControlProc)loader("glClipControl");
+			clipControl = clipControlDepth != nullptr;
+		}
+	}
+};
+
+inline GLExtensions& glExtensions()
+{
+	static GLExtensions extensions;
+	return extensions;
+}
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+// Shadows bound GL state and drops calls that would not change it.
+// Everything that binds during the frame must go through here, code
+// that binds directly has to call invalidate() afterwards.
+// -----------------------------------------------------------------
+class GLState
+{
+public:
+	static const unsigned int MAX_TEXTURE_UNITS = 16;
+	static const unsigned int UNKNOWN = 0xFFFFFFFFu;
+
+	struct Counters
+	{
+		unsigned int issued = 0;
+		unsigned int skipped = 0;
+	};
+
+	GLState()
+	{
+		invalidate();
+	}
+
+	// Forget all shadowed state, the next call of each kind is always issued
+	void invalidate()
+	{
+		program = UNKNOWN;
+		vertexArray = UNKNOWN;
+		activeUnit = UNKNOWN;
+		for (unsigned int i = 0; i < MAX_TEXTURE_UNITS; i++)
+		{
+			textureTarget[i] = 0;
+			texture[i] = UNKNOWN;
+		}
+		arrayBuffer = UNKNOWN;
+		elementBuffer = UNKNOWN;
+		uniformBuffer = UNKNOWN;
+		pixelUnpackBuffer = UNKNOWN;
+		depthTest = UNKNOWN;
+		blend = UNKNOWN;
+		depthFunc = UNKNOWN;
+		blendSource = UNKNOWN;
+		blendDestination = UNKNOWN;
+		polygon = UNKNOWN;
+	}
+
+	// Start a new frame, keeping the previous frame's counters readable
+	void beginFrame()
+	{
+		lastFrame = current;
+		current = Counters();
+	}
+	const Counters& frameCounters() const
+	{
+		return lastFrame;
+	}
+	void printFrameCounters() const
+	{
+		std::cout << "GL state: " << lastFrame.issued << " calls issued, " << lastFrame.skipped << " skipped" << std::endl;
+	}
+
+	void useProgram(unsigned int id)
+	{
+		if (changed(program, id))
+			glUseProgram(id);
+	}
+	void bindVertexArray(unsigned int id)
+	{
+		if (changed(vertexArray, id))
+		{
+			glBindVertexArray(id);
+			// The element buffer binding belongs to the VAO
+			elementBuffer = UNKNOWN;
+		}
+	}
+	void bindTexture(unsigned int unit, GLenum target, unsigned int id)
+	{
+		if (unit >= MAX_TEXTURE_UNITS)
+		{
+			std::cout << "ERROR::GL_STATE::TEXTURE_UNIT_OUT_OF_RANGE " << unit << std::endl;
+			return;
+		}
+		if (textureTarget[unit] == target && texture[unit] == id)
+		{
+			current.skipped++;
+			return;
+		}
+		if (changed(activeUnit, unit))
+			glActiveTexture(GL_TEXTURE0 + unit);
+		current.issued++;
+		glBindTexture(target, id);
+		textureTarget[unit] = target;
+		texture[unit] = id;
+	}
+	void bindBuffer(GLenum target, unsigned int id)
+	{
+		unsigned int* binding = bufferBinding(target);
+		if (!binding)
+		{
+			current.issued++;
+			glBindBuffer(target, id);
+		}
+		else if (changed(*binding, id))
+			glBindBuffer(target, id);
+	}
+	// Indexed binding ranges are not shadowed, but they also set the generic binding
+	void bindBufferRange(GLenum target, unsigned int index, unsigned int id, GLintptr offset, GLsizeiptr size)
+	{
+		current.issued++;
+		glBindBufferRange(target, index, id, offset, size);
+		if (unsigned int* binding = bufferBinding(target))
+			*binding = id;
+	}
+	void setDepthTest(bool enabled)
+	{
+		setCapability(GL_DEPTH_TEST, depthTest, enabled);
+	}
+	void setBlend(bool enabled)
+	{
+		setCapability(GL_BLEND, blend, enabled);
+	}
+	void setDepthFunc(GLenum func)
+	{
+		if (changed(depthFunc, func))
+			glDepthFunc(func);
+	}
+	void setBlendFunc(GLenum source, GLenum destination)
+	{
+		if (blendSource == source && blendDestination == destination)
+		{
+			current.skipped++;
+			return;
+		}
+		current.issued++;
+		glBlendFunc(source, destination);
+		blendSource = source;
+		blendDestination = destination;
+	}
+	void setPolygonMode(GLenum mode)
+	{
+		if (changed(polygon, mode))
+			glPolygonMode(GL_FRONT_AND_BACK, mode);
+	}
+
+private:
+	unsigned int program;
+	unsigned int vertexArray;
+	unsigned int activeUnit;
+	GLenum textureTarget[MAX_TEXTURE_UNITS];
+	unsigned int texture[MAX_TEXTURE_UNITS];
+	unsigned int arrayBuffer;
+	unsigned int elementBuffer;
+	unsigned int uniformBuffer;
+	unsigned int pixelUnpackBuffer;
+	unsigned int depthTest;
+	unsigned int blend;
+	unsigned int depthFunc;
+	unsigned int blendSource;
+	unsigned int blendDestination;
+	unsigned int polygon;
+	Counters current;
+	Counters lastFrame;
+
+	// Update a shadowed value, returns true if the GL call has to be issued
+	bool changed(unsigned int& shadow, unsigned int value)
+	{
+		if (shadow == value)
+		{
+			current.skipped++;
+			return false;
+		}
+		shadow = value;
+		current.issued++;
+		return true;
+	}
+	void setCapability(GLenum capability, unsigned int& shadow, bool enabled)
+	{
+		if (changed(shadow, enabled ? 1u : 0u))
+		{
+			if (enabled)
+				glEnable(capability);
+			else
+				glDisable(capability);
+		}
+	}
+	unsigned int* bufferBinding(GLenum target)
+	{
+		switch (target)
+		{
+		case GL_ARRAY_BUFFER:         return &arrayBuffer;
+		case GL_ELEMENT_ARRAY_BUFFER: return &elementBuffer;
+		case GL_UNIFORM_BUFFER:       return &uniformBuffer;
+		case GL_PIXEL_UNPACK_BUFFER:  return &pixelUnpackBuffer;
+		default:                      return nullptr;
+		}
+	}
+};
+
+// State tracker for the one GL context. It is shared by the whole process and
+// follows the context from the main thread to the render thread and back, so
+// only the thread the context is current on may use it.
+// ---------------------------------------------------------------------------
+inline GLState& glState()
+{
+	static GLState state;
+	return state;
+}
+
+#endif
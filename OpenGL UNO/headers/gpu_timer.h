@@ -0,0 +1,85 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// GPU duration of each frame from a ring of GL_TIME_ELAPSED queries.
+// Results arrive a few frames late, collect() never waits for them.
+// Only one GL_TIME_ELAPSED query can be active, so begin() also fails
+// while another timer is running.
+// ------------------------------------------------------------------
+class GpuTimer
+{
+public:
+	GpuTimer(unsigned int latency = 4)
+		: queries(latency), frames(latency, -1), next(0), oldest(0), running(false)
+	{
+		glGenQueries((GLsizei)latency, queries.data());
+	}
+	~GpuTimer()
+	{
+		glDeleteQueries((GLsizei)queries.size(), queries.data());
+	}
+	GpuTimer(const GpuTimer&) = delete;
+	GpuTimer& operator=(const GpuTimer&) = delete;
+
+	// Time the GL commands of one frame, returns false if every query is still in flight
+	bool begin(int frame)
+	{
+		if (running || elapsedQueryActive() || frames[next] >= 0)
+			return false;
+		glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+		frames[next] = frame;
+		running = elapsedQueryActive() = true;
+		return true;
+	}
+	void end()
+	{
+		if (!running)
+			return;
+		glEndQuery(GL_TIME_ELAPSED);
+		next = (next + 1) % queries.size();
+		running = elapsedQueryActive() = false;
+	}
+
+	// Pop the oldest finished result in order, optionally waiting for it
+	// ------------------------------------------------------------------
+	bool collect(int& frame, double& milliseconds, bool wait = false)
+	{
+		if (frames[oldest] < 0 || (running && oldest == next))
+			return false;
+		if (!wait)
+		{
+			int available = 0;
+			glGetQueryObjectiv(queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				return false;
+		}
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[oldest], GL_QUERY_RESULT, &nanoseconds);
+		frame = frames[oldest];
+		milliseconds = nanoseconds / 1.0e6;
+		frames[oldest] = -1;
+		oldest = (oldest + 1) % queries.size();
+		return true;
+	}
+
+private:
+	std::vector<unsigned int> queries;
+	// Frame each query measures, -1 when the slot is free
+	std::vector<int> frames;
+	size_t next;
+	size_t oldest;
+	bool running;
+
+	// Shared by every timer on the GL thread
+	static bool& elapsedQueryActive()
+	{
+		static bool active = false;
+		return active;
+	}
+};
+
+#endif
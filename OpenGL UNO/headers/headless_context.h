@@ -0,0 +1,168 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <iostream>
+#include <cstring>
+
+// Surfaceless EGL is available wherever Mesa is, other platforms fall back to
+// a hidden GLFW window in main(), which still needs a display. The project
+// only ships the Windows vcxproj, so the EGL path is compiled only by a Linux
+// build that links libEGL alongside GLFW and the glad loader.
+#if defined(__linux__)
+#define UNO_HEADLESS_EGL 1
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// OpenGL context without a window or display. Rendering must go to a
+// framebuffer object, there is no default framebuffer to draw into.
+// Works on Mesa llvmpipe, so benchmarks run on machines without a GPU.
+// -------------------------------------------------------------------
+class HeadlessContext
+{
+public:
+	HeadlessContext() = default;
+	~HeadlessContext()
+	{
+		destroy();
+	}
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	static bool available()
+	{
+#ifdef UNO_HEADLESS_EGL
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Create a core profile context and make it current
+	// -------------------------------------------------
+	bool create(int major, int minor)
+	{
+#ifdef UNO_HEADLESS_EGL
+		// Prefer Mesa's surfaceless platform, it needs neither X11 nor a GPU device node
+		const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+			display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+		if (display == EGL_NO_DISPLAY)
+			display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		EGLint eglMajor, eglMinor;
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, &eglMajor, &eglMinor))
+		{
+			std::cout << "ERROR::HEADLESS::EGL_INITIALIZE_FAILED" << std::endl;
+			display = EGL_NO_DISPLAY;
+			return false;
+		}
+		const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+		if (!hasExtension(extensions, "EGL_KHR_surfaceless_context") || !hasExtension(extensions, "EGL_KHR_create_context"))
+		{
+			std::cout << "ERROR::HEADLESS::SURFACELESS_CONTEXT_UNSUPPORTED" << std::endl;
+			destroy();
+			return false;
+		}
+
+		EGLConfig config = (EGLConfig)0;
+		if (!hasExtension(extensions, "EGL_KHR_no_config_context"))
+		{
+			const EGLint configAttributes[] = {
+				EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+				EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+				EGL_NONE
+			};
+			EGLint configCount = 0;
+			if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+			{
+				std::cout << "ERROR::HEADLESS::NO_CONFIG" << std::endl;
+				destroy();
+				return false;
+			}
+		}
+
+		eglBindAPI(EGL_OPENGL_API);
+		const EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION_KHR, major,
+			EGL_CONTEXT_MINOR_VERSION_KHR, minor,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+			EGL_NONE
+		};
+		context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+		if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+		{
+			std::cout << "ERROR::HEADLESS::CONTEXT_CREATION_FAILED" << std::endl;
+			destroy();
+			return false;
+		}
+		return true;
+#else
+		(void)major;
+		(void)minor;
+		return false;
+#endif
+	}
+
+	// Move the context between threads, it can be current on one thread at a time
+	bool makeCurrent()
+	{
+#ifdef UNO_HEADLESS_EGL
+		return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+#else
+		return false;
+#endif
+	}
+	void release()
+	{
+#ifdef UNO_HEADLESS_EGL
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+#endif
+	}
+
+	void destroy()
+	{
+#ifdef UNO_HEADLESS_EGL
+		if (display == EGL_NO_DISPLAY)
+			return;
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (context != EGL_NO_CONTEXT)
+			eglDestroyContext(display, context);
+		eglTerminate(display);
+		context = EGL_NO_CONTEXT;
+		display = EGL_NO_DISPLAY;
+#endif
+	}
+
+	// Loader for gladLoadGLLoader
+	static void* getProcAddress(const char* name)
+	{
+#ifdef UNO_HEADLESS_EGL
+		return (void*)eglGetProcAddress(name);
+#else
+		(void)name;
+		return NULL;
+#endif
+	}
+
+private:
+#ifdef UNO_HEADLESS_EGL
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+
+	// Extension strings are space separated, match whole names only
+	static bool hasExtension(const char* extensions, const char* name)
+	{
+		if (!extensions)
+			return false;
+		size_t length = std::strlen(name);
+		for (const char* at = std::strstr(extensions, name); at; at = std::strstr(at + length, name))
+			if ((at == extensions || at[-1] == ' ') && (at[length] == ' ' || at[length] == '\0'))
+				return true;
+		return false;
+	}
+#endif
+};
+
+#endif
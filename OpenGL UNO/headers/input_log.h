@@ -0,0 +1,282 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+
+// Keyboard state driven by key events rather than glfwGetKey, so replayed
+// events move the camera exactly like live ones
+// -----------------------------------------------------------------------
+class KeyState
+{
+public:
+	KeyState()
+	{
+		std::memset(down, 0, sizeof(down));
+	}
+	void apply(int key, int action)
+	{
+		if (key >= 0 && key <= GLFW_KEY_LAST)
+			down[key] = action != GLFW_RELEASE;
+	}
+	bool isDown(int key) const
+	{
+		return key >= 0 && key <= GLFW_KEY_LAST && down[key];
+	}
+
+private:
+	bool down[GLFW_KEY_LAST + 1];
+};
+
+// Receivers for input events, called for live and replayed input alike
+// --------------------------------------------------------------------
+struct InputHandlers
+{
+	void (*key)(int key, int scancode, int action, int mods);
+	void (*cursor)(double x, double y);
+	void (*scroll)(double x, double y);
+};
+
+// Binary log of every input event and the time of every frame. Events are
+// stored after the frame whose poll delivered them, each with its offset from
+// the frame time. Replay feeds the recorded frame times to the simulation and
+// dispatches the events at the same point of the same frame, so a recorded run
+// plays back identically, windowed or headless.
+//
+// File: "UNOI", uint32 version, then records of a one byte type and payload
+//   FRAME   double time
+//   KEY     float delay, int32 key, int32 scancode, uint8 action, uint8 mods
+//   CURSOR  float delay, double x, double y
+//   SCROLL  float delay, double x, double y
+// ----------------------------------------------------------------------------
+const char INPUT_LOG_MAGIC[4] = { 'U', 'N', 'O', 'I' };
+const uint32_t INPUT_LOG_VERSION = 1;
+
+enum InputRecordType
+{
+	INPUT_RECORD_FRAME,
+	INPUT_RECORD_KEY,
+	INPUT_RECORD_CURSOR,
+	INPUT_RECORD_SCROLL
+};
+
+class InputLog
+{
+public:
+	InputLog()
+		: mode(MODE_OFF), frameTime(0.0), frames(0), events(0), exhausted(false)
+	{
+	}
+
+	bool record(const char* path)
+	{
+		output.open(path, std::ios::binary | std::ios::trunc);
+		if (!output)
+		{
+			std::cout << "ERROR::INPUT::LOG_NOT_WRITABLE " << path << std::endl;
+			return false;
+		}
+		output.write(INPUT_LOG_MAGIC, 4);
+		write(INPUT_LOG_VERSION);
+		mode = MODE_RECORD;
+		return true;
+	}
+	bool replay(const char* path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		char magic[4];
+		uint32_t version = 0;
+		if (!file || !file.read(magic, 4) || std::memcmp(magic, INPUT_LOG_MAGIC, 4) != 0
+			|| !file.read((char*)&version, sizeof(version)) || version != INPUT_LOG_VERSION)
+		{
+			std::cout << "ERROR::INPUT::LOG_INVALID " << path << std::endl;
+			return false;
+		}
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		cursor = 0;
+		mode = MODE_REPLAY;
+		return true;
+	}
+
+	bool recording() const
+	{
+		return mode == MODE_RECORD;
+	}
+	bool replaying() const
+	{
+		return mode == MODE_REPLAY;
+	}
+	// True once a replay has played its last frame
+	bool finished() const
+	{
+		return exhausted;
+	}
+	unsigned int frameCount() const
+	{
+		return frames;
+	}
+	unsigned int eventCount() const
+	{
+		return events;
+	}
+
+	// Time the main loop starts at, logged like a frame time so replayed
+	// frames measure their deltas from the recorded origin
+	double start(double now)
+	{
+		return syncTime(now);
+	}
+	// Time to run the next frame at. Records the clock while recording and
+	// returns the recorded time while replaying.
+	// ---------------------------------------------------------------------
+	double beginFrame(double now)
+	{
+		now = syncTime(now);
+		if (!exhausted)
+			frames++;
+		return now;
+	}
+
+	// Deliver the replayed events of the current frame, call where live input is polled
+	void dispatch(const InputHandlers& handlers)
+	{
+		if (mode != MODE_REPLAY)
+			return;
+		while (cursor < data.size() && data[cursor] != INPUT_RECORD_FRAME)
+		{
+			unsigned char type = data[cursor++];
+			float delay;
+			if (!read(delay))
+				break;
+			if (type == INPUT_RECORD_KEY)
+			{
+				int32_t key, scancode;
+				uint8_t action, mods;
+				if (!read(key) || !read(scancode) || !read(action) || !read(mods))
+					break;
+				handlers.key(key, scancode, action, mods);
+			}
+			else if (type == INPUT_RECORD_CURSOR || type == INPUT_RECORD_SCROLL)
+			{
+				double x, y;
+				if (!read(x) || !read(y))
+					break;
+				(type == INPUT_RECORD_CURSOR ? handlers.cursor : handlers.scroll)(x, y);
+			}
+			else
+			{
+				std::cout << "ERROR::INPUT::LOG_CORRUPT at byte " << cursor << std::endl;
+				cursor = data.size();
+				break;
+			}
+			events++;
+		}
+	}
+
+	// Live events, written to the log while recording
+	// -----------------------------------------------
+	void recordKey(double now, int key, int scancode, int action, int mods)
+	{
+		if (!beginEvent(INPUT_RECORD_KEY, now))
+			return;
+		write((int32_t)key);
+		write((int32_t)scancode);
+		write((uint8_t)action);
+		write((uint8_t)mods);
+	}
+	void recordCursor(double now, double x, double y)
+	{
+		if (!beginEvent(INPUT_RECORD_CURSOR, now))
+			return;
+		write(x);
+		write(y);
+	}
+	void recordScroll(double now, double x, double y)
+	{
+		if (!beginEvent(INPUT_RECORD_SCROLL, now))
+			return;
+		write(x);
+		write(y);
+	}
+
+	void close()
+	{
+		if (mode == MODE_RECORD)
+			output.close();
+		mode = MODE_OFF;
+	}
+
+private:
+	enum Mode
+	{
+		MODE_OFF,
+		MODE_RECORD,
+		MODE_REPLAY
+	};
+	Mode mode;
+	double frameTime;
+	unsigned int frames;
+	unsigned int events;
+	bool exhausted;
+
+	std::ofstream output;
+	std::vector<char> data;
+	size_t cursor;
+
+	double syncTime(double now)
+	{
+		if (mode == MODE_RECORD)
+		{
+			output.put((char)INPUT_RECORD_FRAME);
+			write(now);
+		}
+		else if (mode == MODE_REPLAY)
+		{
+			if (cursor < data.size() && data[cursor] == INPUT_RECORD_FRAME && cursor + 1 + sizeof(double) <= data.size())
+			{
+				cursor++;
+				read(now);
+			}
+			else
+			{
+				exhausted = true;
+			}
+		}
+		frameTime = now;
+		return now;
+	}
+	bool beginEvent(InputRecordType type, double now)
+	{
+		if (mode != MODE_RECORD)
+			return false;
+		output.put((char)type);
+		write((float)(now - frameTime));
+		events++;
+		return true;
+	}
+	template <typename T>
+	void write(const T& value)
+	{
+		output.write((const char*)&value, sizeof(T));
+	}
+	template <typename T>
+	bool read(T& value)
+	{
+		if (cursor + sizeof(T) > data.size())
+		{
+			cursor = data.size();
+			return false;
+		}
+		std::memcpy(&value, &data[cursor], sizeof(T));
+		cursor += sizeof(T);
+		return true;
+	}
+};
+
+#endif
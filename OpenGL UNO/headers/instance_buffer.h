@@ -0,0 +1,112 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include "gl_state.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class InstanceBuffer
+{
+public:
+	// Buffer IDs
+	unsigned int ID;
+	unsigned int layerID;
+
+	// Creates empty per-instance model matrix and material layer buffers
+	// ------------------------------------------------------------------
+	InstanceBuffer()
+		: capacity(0), layerCapacity(0), instanceCount(0)
+	{
+		glGenBuffers(1, &ID);
+		glGenBuffers(1, &layerID);
+	}
+	~InstanceBuffer()
+	{
+		glDeleteBuffers(1, &ID);
+		glDeleteBuffers(1, &layerID);
+	}
+	InstanceBuffer(const InstanceBuffer&) = delete;
+	InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+	// Attach the buffer to a VAO as a mat4 attribute spanning four
+	// consecutive locations, advancing once per instance
+	// ------------------------------------------------------------
+	void attach(unsigned int VAO, unsigned int location) const
+	{
+		glState().bindVertexArray(VAO);
+		glState().bindBuffer(GL_ARRAY_BUFFER, ID);
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			glVertexAttribPointer(location + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+			glEnableVertexAttribArray(location + column);
+			glVertexAttribDivisor(location + column, 1);
+		}
+		glState().bindVertexArray(0);
+	}
+	// Attach the texture array layer of each instance as a float attribute
+	// --------------------------------------------------------------------
+	void attachLayers(unsigned int VAO, unsigned int location) const
+	{
+		glState().bindVertexArray(VAO);
+		glState().bindBuffer(GL_ARRAY_BUFFER, layerID);
+		glVertexAttribPointer(location, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+		glState().bindVertexArray(0);
+	}
+	// Upload model matrices, only reallocating when the buffer has to grow
+	// --------------------------------------------------------------------
+	void upload(const std::vector<glm::mat4>& matrices)
+	{
+		upload(matrices.data(), (unsigned int)matrices.size());
+	}
+	void upload(const glm::mat4* matrices, unsigned int count)
+	{
+		glState().bindBuffer(GL_ARRAY_BUFFER, ID);
+		if (count > capacity)
+		{
+			glBufferData(GL_ARRAY_BUFFER, count * sizeof(glm::mat4), matrices, GL_DYNAMIC_DRAW);
+			capacity = count;
+		}
+		else if (count > 0)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), matrices);
+		}
+		instanceCount = count;
+	}
+	// Overwrite instances [first, first + count) of an earlier upload with count matrices
+	void updateRange(const glm::mat4* matrices, unsigned int first, unsigned int count)
+	{
+		if (count == 0 || first + count > capacity)
+			return;
+		glState().bindBuffer(GL_ARRAY_BUFFER, ID);
+		glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(glm::mat4), count * sizeof(glm::mat4), matrices);
+	}
+	void uploadLayers(const std::vector<float>& layers)
+	{
+		glState().bindBuffer(GL_ARRAY_BUFFER, layerID);
+		if (layers.size() > layerCapacity)
+		{
+			glBufferData(GL_ARRAY_BUFFER, layers.size() * sizeof(float), layers.data(), GL_DYNAMIC_DRAW);
+			layerCapacity = (unsigned int)layers.size();
+		}
+		else if (!layers.empty())
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, 0, layers.size() * sizeof(float), layers.data());
+		}
+	}
+	unsigned int count() const
+	{
+		return instanceCount;
+	}
+
+private:
+	unsigned int capacity;
+	unsigned int layerCapacity;
+	unsigned int instanceCount;
+};
+
+#endif
@@ -0,0 +1,453 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include "profiler.h"
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Jobs are ranges of work, a single job covers [0, 1)
+typedef void (*JobFunction)(void* data, unsigned int begin, unsigned int end);
+
+// Number of unfinished jobs, each job decrements the counter it was started with
+// -------------------------------------------------------------------------------
+class JobCounter
+{
+public:
+	JobCounter()
+		: remaining(0)
+	{
+	}
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool done() const
+	{
+		return remaining.load(std::memory_order_acquire) == 0;
+	}
+
+private:
+	friend class JobSystem;
+	std::atomic<unsigned int> remaining;
+};
+
+struct Job
+{
+	JobFunction function;
+	void* data;
+	unsigned int begin;
+	unsigned int end;
+	// Range jobs split themselves down to this many items, 0 runs the range whole
+	unsigned int grain;
+	JobCounter* counter;
+};
+
+// Chase-Lev work stealing deque of fixed capacity. The owning thread pushes and
+// pops at the bottom, any other thread steals from the top, all without locks.
+// Memory orders follow Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models" (PPoPP 2013), with the push fence folded into a release store.
+// Jobs are stored by value and copied out before the claim on them is made, so
+// a slot is only ever rewritten after the job in it has been taken.
+// -----------------------------------------------------------------------------
+class WorkStealingQueue
+{
+public:
+	static const unsigned int CAPACITY = 4096;
+
+	WorkStealingQueue()
+		: top(0), bottom(0)
+	{
+	}
+
+	// Owner only, returns false when full
+	bool push(const Job& job)
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		if (b - t >= (int64_t)CAPACITY)
+			return false;
+		buffer[b & (CAPACITY - 1)].store(job);
+		bottom.store(b + 1, std::memory_order_release);
+		return true;
+	}
+	// Owner only, newest job first
+	bool pop(Job& job)
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+		if (t > b)
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		buffer[b & (CAPACITY - 1)].load(job);
+		if (t == b)
+		{
+			// Last job, race the thieves for it
+			bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+	// Any thread, oldest job first. Returns false when empty or when another thief won.
+	bool steal(Job& job)
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return false;
+		// The copy is torn if the owner has since wrapped around, the CAS fails then
+		buffer[t & (CAPACITY - 1)].load(job);
+		return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+	bool empty() const
+	{
+		return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+	}
+
+private:
+	// Job fields as relaxed atomics, a thief copying a slot races no plain stores
+	struct Slot
+	{
+		std::atomic<JobFunction> function;
+		std::atomic<void*> data;
+		std::atomic<unsigned int> begin;
+		std::atomic<unsigned int> end;
+		std::atomic<unsigned int> grain;
+		std::atomic<JobCounter*> counter;
+
+		void store(const Job& job)
+		{
+			function.store(job.function, std::memory_order_relaxed);
+			data.store(job.data, std::memory_order_relaxed);
+			begin.store(job.begin, std::memory_order_relaxed);
+			end.store(job.end, std::memory_order_relaxed);
+			grain.store(job.grain, std::memory_order_relaxed);
+			counter.store(job.counter, std::memory_order_relaxed);
+		}
+		void load(Job& job) const
+		{
+			job.function = function.load(std::memory_order_relaxed);
+			job.data = data.load(std::memory_order_relaxed);
+			job.begin = begin.load(std::memory_order_relaxed);
+			job.end = end.load(std::memory_order_relaxed);
+			job.grain = grain.load(std::memory_order_relaxed);
+			job.counter = counter.load(std::memory_order_relaxed);
+		}
+	};
+
+	// Thieves write top and the owner writes bottom, keep them on separate cache lines
+	std::atomic<int64_t> top;
+	char separation[64 - sizeof(std::atomic<int64_t>)];
+	std::atomic<int64_t> bottom;
+	Slot buffer[CAPACITY];
+};
+
+// Work stealing job system. The thread that creates it becomes worker 0 and
+// the rest run on pinned threads, one per remaining core. Each worker keeps
+// its own deque, takes its newest jobs first and steals the oldest jobs of a
+// random other worker when it runs dry. Submitting, taking and finishing jobs
+// never lock, idle workers only sleep after spinning for a while.
+//
+// Submit jobs from worker 0 or from inside jobs. Other threads run their jobs
+// inline. Each thread can have WorkStealingQueue::CAPACITY jobs in flight,
+// beyond that jobs run inline as well.
+//
+//   auto body = [&](unsigned int begin, unsigned int end) { ... };
+//   JobCounter counter;
+//   jobs.parallelFor(counter, count, body);
+//   jobs.wait(counter);
+// ---------------------------------------------------------------------------
+class JobSystem
+{
+public:
+	// 0 uses every hardware thread
+	JobSystem(unsigned int threadCount = 0)
+		: running(true), sleepers(0)
+	{
+		if (threadCount == 0)
+			threadCount = std::thread::hardware_concurrency();
+		if (threadCount == 0)
+			threadCount = 1;
+		for (unsigned int i = 0; i < threadCount; i++)
+			workers.push_back(std::unique_ptr<Worker>(new Worker(i)));
+		currentWorker() = workers[0].get();
+		for (unsigned int i = 1; i < threadCount; i++)
+			workers[i]->thread = std::thread(&JobSystem::workerLoop, this, workers[i].get());
+	}
+	~JobSystem()
+	{
+		running.store(false);
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			wake.notify_all();
+		}
+		for (unsigned int i = 1; i < workers.size(); i++)
+			workers[i]->thread.join();
+		if (currentWorker() == workers[0].get())
+			currentWorker() = nullptr;
+	}
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	unsigned int threadCount() const
+	{
+		return (unsigned int)workers.size();
+	}
+
+	// Run function(data, 0, 1) as one job
+	void run(JobCounter& counter, JobFunction function, void* data)
+	{
+		Job job = { function, data, 0, 1, 0, &counter };
+		submit(job);
+	}
+	// Run function over [0, count). The range splits in half whenever the
+	// worker running it has nothing else queued, so ranges break up as far as
+	// idle workers need and no further, down to grain items. A grain of 0
+	// picks one that leaves about 64 pieces per thread.
+	// ------------------------------------------------------------------------
+	void runRange(JobCounter& counter, JobFunction function, void* data, unsigned int count, unsigned int grain = 0)
+	{
+		if (count == 0)
+			return;
+		if (grain == 0)
+			grain = count / (threadCount() * 64);
+		Job job = { function, data, 0, count, grain > 0 ? grain : 1, &counter };
+		submit(job);
+	}
+	// runRange for a callable taking (begin, end). The callable is referenced,
+	// not copied, it must outlive the wait on counter. Temporaries would not.
+	template <typename Body>
+	void parallelFor(JobCounter& counter, unsigned int count, const Body& body, unsigned int grain = 0)
+	{
+		runRange(counter, &JobSystem::callRange<Body>, (void*)&body, count, grain);
+	}
+	template <typename Body>
+	void parallelFor(JobCounter& counter, unsigned int count, const Body&& body, unsigned int grain = 0) = delete;
+
+	// Run queued jobs until counter reaches zero, jobs may wait on other counters
+	// ---------------------------------------------------------------------------
+	void wait(const JobCounter& counter)
+	{
+		PROFILE_SCOPE("Job wait");
+		Worker* worker = currentWorker();
+		unsigned int idle = 0;
+		while (!counter.done())
+		{
+			Job job;
+			if (worker && take(*worker, job))
+			{
+				execute(worker, job);
+				idle = 0;
+			}
+			else if (++idle > 64)
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+private:
+	struct Worker
+	{
+		unsigned int index;
+		uint32_t random;
+		WorkStealingQueue queue;
+		std::thread thread;
+
+		Worker(unsigned int workerIndex)
+			: index(workerIndex), random(workerIndex * 2654435761u + 1)
+		{
+		}
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::atomic<bool> running;
+	// Idle workers park on the condition variable, the lock is only taken to
+	// sleep and to wake sleepers
+	std::atomic<unsigned int> sleepers;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+
+	static Worker*& currentWorker()
+	{
+		thread_local Worker* worker = nullptr;
+		return worker;
+	}
+	template <typename Body>
+	static void callRange(void* body, unsigned int begin, unsigned int end)
+	{
+		(*(const Body*)body)(begin, end);
+	}
+
+	void submit(const Job& job)
+	{
+		job.counter->remaining.fetch_add(1, std::memory_order_relaxed);
+		Worker* worker = currentWorker();
+		if (!worker || !push(*worker, job))
+		{
+			Job inlineJob = job;
+			execute(worker, inlineJob);
+		}
+	}
+	bool push(Worker& worker, const Job& job)
+	{
+		if (!worker.queue.push(job))
+			return false;
+		// Pairs with the fence in sleep(), either the sleeper sees the job or we see the sleeper
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sleepers.load(std::memory_order_relaxed) > 0)
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			wake.notify_one();
+		}
+		return true;
+	}
+
+	// Own jobs first, then steal starting from a random victim
+	bool take(Worker& worker, Job& job)
+	{
+		if (worker.queue.pop(job))
+			return true;
+		unsigned int count = (unsigned int)workers.size();
+		if (count < 2)
+			return false;
+		worker.random ^= worker.random << 13;
+		worker.random ^= worker.random >> 17;
+		worker.random ^= worker.random << 5;
+		unsigned int start = worker.random % count;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			Worker& victim = *workers[(start + i) % count];
+			if (&victim == &worker)
+				continue;
+			if (victim.queue.steal(job))
+				return true;
+		}
+		return false;
+	}
+
+	void execute(Worker* worker, Job& job)
+	{
+		if (job.grain > 0)
+		{
+			while (job.begin < job.end)
+			{
+				// Lazy binary splitting: hand half the range to thieves while our
+				// own queue is empty, otherwise keep working through it
+				unsigned int remaining = job.end - job.begin;
+				if (worker && remaining >= 2 * job.grain && worker->queue.empty())
+				{
+					Job half = job;
+					half.begin = job.begin + remaining / 2;
+					job.counter->remaining.fetch_add(1, std::memory_order_relaxed);
+					if (push(*worker, half))
+					{
+						job.end = half.begin;
+						continue;
+					}
+					job.counter->remaining.fetch_sub(1, std::memory_order_relaxed);
+				}
+				unsigned int chunkEnd = remaining > job.grain ? job.begin + job.grain : job.end;
+				job.function(job.data, job.begin, chunkEnd);
+				job.begin = chunkEnd;
+			}
+		}
+		else
+		{
+			job.function(job.data, job.begin, job.end);
+		}
+		job.counter->remaining.fetch_sub(1, std::memory_order_release);
+	}
+
+	void workerLoop(Worker* worker)
+	{
+		currentWorker() = worker;
+		pin(worker->index);
+		PROFILE_THREAD_NAME("Job worker");
+		unsigned int idle = 0;
+		while (running.load(std::memory_order_relaxed))
+		{
+			Job job;
+			if (take(*worker, job))
+			{
+				execute(worker, job);
+				idle = 0;
+			}
+			else if (++idle < 64)
+			{
+				continue;
+			}
+			else if (idle < 256)
+			{
+				std::this_thread::yield();
+			}
+			else
+			{
+				sleep();
+				idle = 0;
+			}
+		}
+	}
+	void sleep()
+	{
+		sleepers.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		{
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			if (running.load(std::memory_order_relaxed) && !hasWork())
+				wake.wait_for(lock, std::chrono::milliseconds(1));
+		}
+		sleepers.fetch_sub(1, std::memory_order_relaxed);
+	}
+	bool hasWork() const
+	{
+		for (const std::unique_ptr<Worker>& worker : workers)
+			if (!worker->queue.empty())
+				return true;
+		return false;
+	}
+
+	// Keep a worker on one core so its cache stays warm
+	static void pin(unsigned int index)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		if (cores == 0)
+			return;
+#if defined(_WIN32)
+		SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (index % cores));
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(index % cores, &set);
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+		(void)index;
+#endif
+	}
+};
+
+#endif
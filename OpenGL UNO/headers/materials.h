@@ -0,0 +1,34 @@
+#ifndef MATERIALS_H
+#define MATERIALS_H
+
+// Materials in texture array layer order, shared by the runtime and the cooker
+// ----------------------------------------------------------------------------
+enum MaterialID
+{
+	MATERIAL_CONTAINER,
+	MATERIAL_FACE,
+	MATERIAL_COBBLE,
+	MATERIAL_GRASS,
+	MATERIAL_COUNT
+};
+
+struct MaterialSource
+{
+	const char* path;
+	bool flipVertically;
+};
+
+const MaterialSource MATERIAL_SOURCES[MATERIAL_COUNT] = {
+	{ "textures/container.jpg", false },
+	{ "textures/awesomeface.png", true },
+	{ "textures/cobble.png", false },
+	{ "textures/grass.jpg", false }
+};
+
+// Every layer of the material array has this size
+const int MATERIAL_LAYER_SIZE = 512;
+
+// Cooked material array written by --cook-textures
+const char* const COOKED_MATERIALS_PATH = "textures/materials.unotex";
+
+#endif
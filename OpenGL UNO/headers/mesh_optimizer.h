@@ -0,0 +1,183 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <vector>
+#include <cstring>
+#include <unordered_map>
+
+// Deduplicated vertex data with a triangle list index buffer
+// ----------------------------------------------------------
+struct IndexedMesh
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	unsigned int floatsPerVertex;
+
+	unsigned int vertexCount() const
+	{
+		return (unsigned int)(vertices.size() / floatsPerVertex);
+	}
+};
+
+// Merge bitwise identical vertices of an expanded triangle list
+// -------------------------------------------------------------
+inline IndexedMesh buildIndexedMesh(const float* vertices, unsigned int vertexCount, unsigned int floatsPerVertex)
+{
+	struct VertexHash
+	{
+		unsigned int floats;
+		size_t operator()(const float* v) const
+		{
+			// FNV-1a over the vertex bytes
+			const unsigned char* bytes = (const unsigned char*)v;
+			size_t hash = 2166136261u;
+			for (size_t i = 0; i < floats * sizeof(float); i++)
+			{
+				hash ^= bytes[i];
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+	};
+	struct VertexEqual
+	{
+		unsigned int floats;
+		bool operator()(const float* a, const float* b) const
+		{
+			return std::memcmp(a, b, floats * sizeof(float)) == 0;
+		}
+	};
+
+	IndexedMesh mesh;
+	mesh.floatsPerVertex = floatsPerVertex;
+	mesh.indices.reserve(vertexCount);
+	std::unordered_map<const float*, unsigned int, VertexHash, VertexEqual> unique(vertexCount, VertexHash{ floatsPerVertex }, VertexEqual{ floatsPerVertex });
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const float* vertex = vertices + (size_t)i * floatsPerVertex;
+		auto found = unique.find(vertex);
+		if (found == unique.end())
+		{
+			unsigned int index = (unsigned int)unique.size();
+			unique.emplace(vertex, index);
+			mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + floatsPerVertex);
+			mesh.indices.push_back(index);
+		}
+		else
+		{
+			mesh.indices.push_back(found->second);
+		}
+	}
+	return mesh;
+}
+
+// Average cache miss ratio (transformed vertices per triangle) for a
+// FIFO post-transform cache of the given size
+// ------------------------------------------------------------------
+inline float computeACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16)
+{
+	if (indices.size() < 3)
+		return 0.0f;
+	std::vector<unsigned int> insertedAt(vertexCount, 0);
+	unsigned int clock = cacheSize + 1;
+	unsigned int misses = 0;
+	for (unsigned int index : indices)
+	{
+		// A vertex is resident if fewer than cacheSize misses happened since it was inserted
+		if (insertedAt[index] == 0 || clock - insertedAt[index] > cacheSize)
+		{
+			insertedAt[index] = clock++;
+			misses++;
+		}
+	}
+	return (float)misses / (float)(indices.size() / 3);
+}
+
+// Reorder triangles for post-transform cache reuse (Tipsify, Sander et al. 2007)
+// ------------------------------------------------------------------------------
+inline void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16)
+{
+	unsigned int triangleCount = (unsigned int)(indices.size() / 3);
+	if (triangleCount == 0)
+		return;
+
+	// Vertex to triangle adjacency as offsets into a flat array
+	std::vector<unsigned int> live(vertexCount, 0);
+	for (unsigned int index : indices)
+		live[index]++;
+	std::vector<unsigned int> offsets(vertexCount + 1, 0);
+	for (unsigned int v = 0; v < vertexCount; v++)
+		offsets[v + 1] = offsets[v] + live[v];
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (unsigned int t = 0; t < triangleCount; t++)
+		for (unsigned int c = 0; c < 3; c++)
+			adjacency[fill[indices[t * 3 + c]]++] = t;
+
+	std::vector<unsigned int> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> output;
+	output.reserve(indices.size());
+
+	unsigned int timestamp = cacheSize + 1;
+	unsigned int cursor = 0;
+	int fanning = 0;
+	while (fanning >= 0)
+	{
+		// Emit every remaining triangle around the fanning vertex
+		candidates.clear();
+		for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+		{
+			unsigned int t = adjacency[a];
+			if (emitted[t])
+				continue;
+			for (unsigned int c = 0; c < 3; c++)
+			{
+				unsigned int v = indices[t * 3 + c];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (timestamp - cacheTime[v] > cacheSize)
+					cacheTime[v] = timestamp++;
+			}
+			emitted[t] = true;
+		}
+
+		// Prefer the candidate that is still in cache and has the fewest triangles left
+		fanning = -1;
+		int best = -1;
+		for (unsigned int v : candidates)
+		{
+			if (live[v] == 0)
+				continue;
+			int priority = 0;
+			if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize)
+				priority = (int)(timestamp - cacheTime[v]);
+			if (priority > best)
+			{
+				best = priority;
+				fanning = (int)v;
+			}
+		}
+		// Otherwise fall back to the dead-end stack, then to a linear scan
+		while (fanning < 0 && !deadEnd.empty())
+		{
+			unsigned int v = deadEnd.back();
+			deadEnd.pop_back();
+			if (live[v] > 0)
+				fanning = (int)v;
+		}
+		while (fanning < 0 && cursor < vertexCount)
+		{
+			if (live[cursor] > 0)
+				fanning = (int)cursor;
+			cursor++;
+		}
+	}
+	indices.swap(output);
+}
+
+#endif
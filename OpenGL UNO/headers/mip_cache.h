@@ -0,0 +1,111 @@
+#ifndef MIP_CACHE_H
+#define MIP_CACHE_H
+
+#include "mipmap.h"
+#include "texture_array.h"
+#include "texture_cooker.h"
+#include "cooked_texture.h"
+#include "file_cache.h"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <cstdint>
+#include <thread>
+#include <functional>
+
+// Generated mip chains are stored as uncompressed cooked containers named
+// after a hash of the source file's bytes and the settings used to build them
+// ----------------------------------------------------------------------------
+const uint32_t MIP_CACHE_VERSION = 1;
+
+// Cache file for a source and its build settings, empty if the source is unreadable
+inline std::string mipCachePath(const char* sourcePath, bool flipVertically, int layerSize, MipFilter filter, bool srgb)
+{
+	std::ifstream file(sourcePath, std::ios::binary);
+	if (!file)
+		return std::string();
+	std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	uint64_t hash = hashBytes(bytes.data(), bytes.size());
+	uint32_t settings[5] = { MIP_CACHE_VERSION, (uint32_t)flipVertically, (uint32_t)layerSize, (uint32_t)filter, (uint32_t)srgb };
+	hash = hashBytes(settings, sizeof(settings), hash);
+
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+	return std::string(CACHE_DIRECTORY) + "/" + name + ".unotex";
+}
+
+// A cached container is only used if it holds the full chain for layerSize,
+// a stale or damaged file with other levels is rebuilt instead
+inline bool cachedChainMatches(const CookedTexture& cached, int layerSize)
+{
+	const CookedTextureHeader& info = cached.info();
+	if (info.format != COOKED_RGBA8 || info.layers != 1 || info.levels != mipLevelCount(layerSize))
+		return false;
+	for (uint32_t level = 0; level < info.levels; level++)
+	{
+		const CookedLevel& entry = cached.levelInfo(level);
+		uint32_t dimension = (uint32_t)mipLevelSize(layerSize, level);
+		if (entry.width != dimension || entry.height != dimension)
+			return false;
+	}
+	return true;
+}
+
+// Decode, fit to layerSize and build the mip chain of an image, or read the
+// chain back from the cache. Returns false if the source could not be loaded.
+// ---------------------------------------------------------------------------
+inline bool loadMipChain(const char* sourcePath, bool flipVertically, int layerSize, MipFilter filter, bool srgb,
+	std::vector<Image>& levels, bool* cacheHit = nullptr)
+{
+	if (cacheHit)
+		*cacheHit = false;
+	levels.clear();
+	std::string cachePath = mipCachePath(sourcePath, flipVertically, layerSize, filter, srgb);
+
+	CookedTexture cached;
+	if (!cachePath.empty() && cached.open(cachePath.c_str()) && cachedChainMatches(cached, layerSize))
+	{
+		levels.resize(cached.info().levels);
+		for (uint32_t level = 0; level < cached.info().levels; level++)
+		{
+			const CookedLevel& entry = cached.levelInfo(level);
+			levels[level].width = (int)entry.width;
+			levels[level].height = (int)entry.height;
+			levels[level].channels = 4;
+			const unsigned char* texels = cached.layerData(level, 0);
+			levels[level].pixels.assign(texels, texels + entry.size);
+		}
+		if (cacheHit)
+			*cacheHit = true;
+		return true;
+	}
+
+	Image image;
+	if (!image.load(sourcePath, 4, flipVertically))
+		return false;
+	if (image.width != layerSize || image.height != layerSize)
+		image = resizeImage(image, layerSize, layerSize);
+	generateMipChain(image, filter, srgb, levels);
+
+	// Write under a temporary name so a concurrent reader never sees a partial file
+	if (!cachePath.empty())
+	{
+		makeDirectory(CACHE_DIRECTORY);
+		char suffix[32];
+		std::snprintf(suffix, sizeof(suffix), ".%zx.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+		std::string temporary = cachePath + suffix;
+		std::vector<std::vector<Image>> chains(1, levels);
+		if (writeCookedTexture(temporary.c_str(), chains, COOKED_RGBA8) > 0)
+		{
+			std::remove(cachePath.c_str());
+			if (std::rename(temporary.c_str(), cachePath.c_str()) != 0)
+				std::remove(temporary.c_str());
+		}
+	}
+	return true;
+}
+
+#endif
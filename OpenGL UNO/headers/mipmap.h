@@ -0,0 +1,430 @@
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include "simd.h"
+#include "texture_array.h"
+
+#include <vector>
+#include <cmath>
+
+enum MipFilter
+{
+	// 2x2 average
+	MIP_FILTER_BOX,
+	// 8 tap Kaiser windowed sinc, sharper with less aliasing than the box
+	MIP_FILTER_KAISER
+};
+
+// RGBA float texels, colour in linear light
+struct LinearImage
+{
+	int width = 0;
+	int height = 0;
+	std::vector<float> texels;
+
+	void resize(int w, int h)
+	{
+		width = w;
+		height = h;
+		texels.resize((size_t)w * h * 4);
+	}
+};
+
+// sRGB <-> linear lookup tables
+// -----------------------------
+struct SRGBTables
+{
+	float toLinear[256];
+	// Indexed by linear value * (LINEAR_STEPS - 1)
+	static const int LINEAR_STEPS = 4096;
+	unsigned char toSRGB[LINEAR_STEPS];
+
+	SRGBTables()
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			float c = i / 255.0f;
+			toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i < LINEAR_STEPS; i++)
+		{
+			float l = (float)i / (LINEAR_STEPS - 1);
+			float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+			toSRGB[i] = (unsigned char)(c * 255.0f + 0.5f);
+		}
+	}
+};
+inline const SRGBTables& srgbTables()
+{
+	static SRGBTables tables;
+	return tables;
+}
+
+// Expand an RGBA8 image, alpha is always linear
+inline void imageToLinear(const Image& image, bool srgb, LinearImage& result)
+{
+	const SRGBTables& tables = srgbTables();
+	result.resize(image.width, image.height);
+	size_t count = (size_t)image.width * image.height * 4;
+	for (size_t i = 0; i < count; i += 4)
+	{
+		for (int c = 0; c < 3; c++)
+			result.texels[i + c] = srgb ? tables.toLinear[image.pixels[i + c]] : image.pixels[i + c] / 255.0f;
+		result.texels[i + 3] = image.pixels[i + 3] / 255.0f;
+	}
+}
+
+// Clamp and quantize back to RGBA8, re-encoding colour as sRGB
+inline void linearToImage(const LinearImage& linear, bool srgb, Image& image, bool simd = true)
+{
+	const SRGBTables& tables = srgbTables();
+	image.width = linear.width;
+	image.height = linear.height;
+	image.channels = 4;
+	size_t count = (size_t)linear.width * linear.height * 4;
+	image.pixels.resize(count);
+	size_t i = 0;
+#if defined(UNO_SIMD_AVX2) || defined(UNO_SIMD_SSE2)
+	// Clamp and scale four channels at once, only the table lookups stay scalar
+	if (simd)
+	{
+		const float colorScale = srgb ? (float)(SRGBTables::LINEAR_STEPS - 1) : 255.0f;
+		const __m128 scale = _mm_setr_ps(colorScale, colorScale, colorScale, 255.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		alignas(16) int indices[4];
+		for (; i < count; i += 4)
+		{
+			__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&linear.texels[i]), zero), one);
+			_mm_store_si128((__m128i*)indices, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half)));
+			unsigned char* texel = &image.pixels[i];
+			if (srgb)
+			{
+				texel[0] = tables.toSRGB[indices[0]];
+				texel[1] = tables.toSRGB[indices[1]];
+				texel[2] = tables.toSRGB[indices[2]];
+			}
+			else
+			{
+				texel[0] = (unsigned char)indices[0];
+				texel[1] = (unsigned char)indices[1];
+				texel[2] = (unsigned char)indices[2];
+			}
+			texel[3] = (unsigned char)indices[3];
+		}
+	}
+#endif
+	for (; i < count; i++)
+	{
+		float value = linear.texels[i];
+		value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		if (srgb && (i & 3) != 3)
+			image.pixels[i] = tables.toSRGB[(int)(value * (SRGBTables::LINEAR_STEPS - 1) + 0.5f)];
+		else
+			image.pixels[i] = (unsigned char)(value * 255.0f + 0.5f);
+	}
+}
+
+// Normalized Kaiser windowed sinc taps for a 2x reduction. Tap k samples
+// the source texel k - 3.5 texels from the destination texel's centre.
+// ----------------------------------------------------------------------
+const int KAISER_TAPS = 8;
+
+struct KaiserWeights
+{
+	float taps[KAISER_TAPS];
+
+	KaiserWeights()
+	{
+		const double alpha = 4.0;
+		const double halfWidth = KAISER_TAPS / 4.0;
+		const double pi = 3.14159265358979323846;
+		double sum = 0.0;
+		for (int k = 0; k < KAISER_TAPS; k++)
+		{
+			// Distance in destination texels
+			double t = (k - (KAISER_TAPS - 1) * 0.5) * 0.5;
+			double sinc = std::sin(pi * t) / (pi * t);
+			double ratio = t / halfWidth;
+			double window = besselI0(alpha * std::sqrt(1.0 - ratio * ratio)) / besselI0(alpha);
+			taps[k] = (float)(sinc * window);
+			sum += taps[k];
+		}
+		for (int k = 0; k < KAISER_TAPS; k++)
+			taps[k] = (float)(taps[k] / sum);
+	}
+	static double besselI0(double x)
+	{
+		double sum = 1.0, term = 1.0;
+		for (int k = 1; k < 32; k++)
+		{
+			term *= (x * 0.5 / k) * (x * 0.5 / k);
+			sum += term;
+		}
+		return sum;
+	}
+};
+inline const KaiserWeights& kaiserWeights()
+{
+	static KaiserWeights weights;
+	return weights;
+}
+
+// Wrapped texel index, textures tile so the filters wrap around the edges
+inline int wrapIndex(int i, int size)
+{
+	i %= size;
+	return i < 0 ? i + size : i;
+}
+
+// Box filter, odd edges repeat the last texel
+// -------------------------------------------
+inline void boxDownsampleScalar(const LinearImage& source, LinearImage& result)
+{
+	result.resize(source.width > 1 ? source.width / 2 : 1, source.height > 1 ? source.height / 2 : 1);
+	for (int y = 0; y < result.height; y++)
+	{
+		const float* row0 = &source.texels[(size_t)(y * 2) * source.width * 4];
+		const float* row1 = &source.texels[(size_t)(y * 2 + 1 < source.height ? y * 2 + 1 : source.height - 1) * source.width * 4];
+		float* out = &result.texels[(size_t)y * result.width * 4];
+		for (int x = 0; x < result.width; x++)
+		{
+			int x0 = x * 2 * 4, x1 = (x * 2 + 1 < source.width ? x * 2 + 1 : source.width - 1) * 4;
+			for (int c = 0; c < 4; c++)
+				out[x * 4 + c] = ((row0[x0 + c] + row1[x0 + c]) + (row0[x1 + c] + row1[x1 + c])) * 0.25f;
+		}
+	}
+}
+
+#if defined(UNO_SIMD_AVX2) || defined(UNO_SIMD_SSE2)
+inline void boxDownsampleSIMD(const LinearImage& source, LinearImage& result)
+{
+	result.resize(source.width > 1 ? source.width / 2 : 1, source.height > 1 ? source.height / 2 : 1);
+	const __m128 quarter = _mm_set1_ps(0.25f);
+	for (int y = 0; y < result.height; y++)
+	{
+		const float* row0 = &source.texels[(size_t)(y * 2) * source.width * 4];
+		const float* row1 = &source.texels[(size_t)(y * 2 + 1 < source.height ? y * 2 + 1 : source.height - 1) * source.width * 4];
+		float* out = &result.texels[(size_t)y * result.width * 4];
+		int x = 0;
+#if defined(UNO_SIMD_AVX2)
+		// Two destination texels from four source texels per row
+		const __m256 quarter8 = _mm256_set1_ps(0.25f);
+		for (; x + 1 < result.width && x * 2 + 3 < source.width; x += 2)
+		{
+			__m256 a = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8), _mm256_loadu_ps(row1 + x * 8));
+			__m256 b = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8 + 8), _mm256_loadu_ps(row1 + x * 8 + 8));
+			__m256 left = _mm256_permute2f128_ps(a, b, 0x20);
+			__m256 right = _mm256_permute2f128_ps(a, b, 0x31);
+			_mm256_storeu_ps(out + x * 4, _mm256_mul_ps(_mm256_add_ps(left, right), quarter8));
+		}
+#endif
+		for (; x < result.width; x++)
+		{
+			int x0 = x * 2 * 4, x1 = (x * 2 + 1 < source.width ? x * 2 + 1 : source.width - 1) * 4;
+			__m128 left = _mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row1 + x0));
+			__m128 right = _mm_add_ps(_mm_loadu_ps(row0 + x1), _mm_loadu_ps(row1 + x1));
+			_mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(left, right), quarter));
+		}
+	}
+}
+#endif
+
+// Separable Kaiser filter, horizontal into scratch then vertical
+// --------------------------------------------------------------
+inline void kaiserDownsampleScalar(const LinearImage& source, LinearImage& result, LinearImage& scratch)
+{
+	const float* w = kaiserWeights().taps;
+	const int half = KAISER_TAPS / 2 - 1;
+	scratch.resize(source.width > 1 ? source.width / 2 : 1, source.height);
+	for (int y = 0; y < source.height; y++)
+	{
+		const float* row = &source.texels[(size_t)y * source.width * 4];
+		float* out = &scratch.texels[(size_t)y * scratch.width * 4];
+		for (int x = 0; x < scratch.width; x++)
+		{
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int k = 0; k < KAISER_TAPS; k++)
+			{
+				const float* texel = row + wrapIndex(x * 2 - half + k, source.width) * 4;
+				for (int c = 0; c < 4; c++)
+					sum[c] += w[k] * texel[c];
+			}
+			for (int c = 0; c < 4; c++)
+				out[x * 4 + c] = sum[c];
+		}
+	}
+
+	result.resize(scratch.width, source.height > 1 ? source.height / 2 : 1);
+	const int rowFloats = scratch.width * 4;
+	for (int y = 0; y < result.height; y++)
+	{
+		const float* rows[KAISER_TAPS];
+		for (int k = 0; k < KAISER_TAPS; k++)
+			rows[k] = &scratch.texels[(size_t)wrapIndex(y * 2 - half + k, scratch.height) * rowFloats];
+		float* out = &result.texels[(size_t)y * rowFloats];
+		for (int i = 0; i < rowFloats; i++)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < KAISER_TAPS; k++)
+				sum += w[k] * rows[k][i];
+			out[i] = sum;
+		}
+	}
+}
+
+#if defined(UNO_SIMD_AVX2) || defined(UNO_SIMD_SSE2)
+inline void kaiserDownsampleSIMD(const LinearImage& source, LinearImage& result, LinearImage& scratch)
+{
+	const float* w = kaiserWeights().taps;
+	const int half = KAISER_TAPS / 2 - 1;
+	__m128 weights[KAISER_TAPS];
+	for (int k = 0; k < KAISER_TAPS; k++)
+		weights[k] = _mm_set1_ps(w[k]);
+
+#if defined(UNO_SIMD_AVX2)
+	// Each load holds source texels j and j + 1. Destination x weighs them with
+	// taps j and j + 1, destination x + 1 with taps j - 2 and j - 1, and the
+	// halves of each sum are added at the end.
+	__m256 pairWeights[KAISER_TAPS / 2 + 1];
+	__m256 nextPairWeights[KAISER_TAPS / 2 + 1];
+	for (int j = 0; j <= KAISER_TAPS / 2; j++)
+	{
+		int k = j * 2;
+		pairWeights[j] = k < KAISER_TAPS ? _mm256_setr_ps(w[k], w[k], w[k], w[k], w[k + 1], w[k + 1], w[k + 1], w[k + 1]) : _mm256_setzero_ps();
+		nextPairWeights[j] = k > 0 ? _mm256_setr_ps(w[k - 2], w[k - 2], w[k - 2], w[k - 2], w[k - 1], w[k - 1], w[k - 1], w[k - 1]) : _mm256_setzero_ps();
+	}
+#endif
+
+	// Horizontal, one RGBA texel per SSE register or two per AVX register
+	scratch.resize(source.width > 1 ? source.width / 2 : 1, source.height);
+	for (int y = 0; y < source.height; y++)
+	{
+		const float* row = &source.texels[(size_t)y * source.width * 4];
+		float* out = &scratch.texels[(size_t)y * scratch.width * 4];
+		for (int x = 0; x < scratch.width; x++)
+		{
+			int first = x * 2 - half;
+#if defined(UNO_SIMD_AVX2)
+			// Two destination texels at a time away from the wrapped edges
+			if (x + 1 < scratch.width && first >= 0 && first + KAISER_TAPS + 2 <= source.width)
+			{
+				const float* texel = row + first * 4;
+				__m256 sum = _mm256_setzero_ps();
+				__m256 nextSum = _mm256_setzero_ps();
+				for (int j = 0; j <= KAISER_TAPS / 2; j++)
+				{
+					__m256 pair = _mm256_loadu_ps(texel + j * 8);
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(pairWeights[j], pair));
+					nextSum = _mm256_add_ps(nextSum, _mm256_mul_ps(nextPairWeights[j], pair));
+				}
+				__m256 halves = _mm256_add_ps(_mm256_permute2f128_ps(sum, nextSum, 0x20), _mm256_permute2f128_ps(sum, nextSum, 0x31));
+				_mm256_storeu_ps(out + x * 4, halves);
+				x++;
+				continue;
+			}
+#endif
+			__m128 sum = _mm_setzero_ps();
+			if (first >= 0 && first + KAISER_TAPS <= source.width)
+			{
+				const float* texel = row + first * 4;
+				for (int k = 0; k < KAISER_TAPS; k++)
+					sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], _mm_loadu_ps(texel + k * 4)));
+			}
+			else
+			{
+				for (int k = 0; k < KAISER_TAPS; k++)
+					sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], _mm_loadu_ps(row + wrapIndex(first + k, source.width) * 4)));
+			}
+			_mm_storeu_ps(out + x * 4, sum);
+		}
+	}
+
+	// Vertical, every float of a row is independent
+	result.resize(scratch.width, source.height > 1 ? source.height / 2 : 1);
+	const int rowFloats = scratch.width * 4;
+	for (int y = 0; y < result.height; y++)
+	{
+		const float* rows[KAISER_TAPS];
+		for (int k = 0; k < KAISER_TAPS; k++)
+			rows[k] = &scratch.texels[(size_t)wrapIndex(y * 2 - half + k, scratch.height) * rowFloats];
+		float* out = &result.texels[(size_t)y * rowFloats];
+		int i = 0;
+#if defined(UNO_SIMD_AVX2)
+		__m256 weights8[KAISER_TAPS];
+		for (int k = 0; k < KAISER_TAPS; k++)
+			weights8[k] = _mm256_set1_ps(w[k]);
+		for (; i + 8 <= rowFloats; i += 8)
+		{
+			__m256 sum = _mm256_setzero_ps();
+			for (int k = 0; k < KAISER_TAPS; k++)
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(weights8[k], _mm256_loadu_ps(rows[k] + i)));
+			_mm256_storeu_ps(out + i, sum);
+		}
+#endif
+		for (; i < rowFloats; i += 4)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (int k = 0; k < KAISER_TAPS; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(weights[k], _mm_loadu_ps(rows[k] + i)));
+			_mm_storeu_ps(out + i, sum);
+		}
+	}
+}
+#endif
+
+// Halve a linear image with the chosen filter
+// -------------------------------------------
+inline void downsampleLinear(const LinearImage& source, LinearImage& result, LinearImage& scratch, MipFilter filter, bool simd = true)
+{
+#if defined(UNO_SIMD_AVX2) || defined(UNO_SIMD_SSE2)
+	if (simd)
+	{
+		if (filter == MIP_FILTER_KAISER)
+			kaiserDownsampleSIMD(source, result, scratch);
+		else
+			boxDownsampleSIMD(source, result);
+		return;
+	}
+#endif
+	if (filter == MIP_FILTER_KAISER)
+		kaiserDownsampleScalar(source, result, scratch);
+	else
+		boxDownsampleScalar(source, result);
+}
+
+// Levels in the full chain of a size x size image, log2(size) + 1
+inline unsigned int mipLevelCount(int size)
+{
+	unsigned int count = 1;
+	while ((size >> count) > 0)
+		count++;
+	return count;
+}
+// Width and height of one level of that chain
+inline int mipLevelSize(int size, unsigned int level)
+{
+	return (size >> level) > 0 ? size >> level : 1;
+}
+
+// Full mip chain of an RGBA8 image down to 1x1. Levels are filtered from
+// the previous float level so quantization error does not accumulate.
+// ----------------------------------------------------------------------
+inline void generateMipChain(const Image& base, MipFilter filter, bool srgb, std::vector<Image>& levels, bool simd = true)
+{
+	levels.clear();
+	levels.push_back(base);
+	LinearImage current, next, scratch;
+	imageToLinear(base, srgb, current);
+	while (current.width > 1 || current.height > 1)
+	{
+		downsampleLinear(current, next, scratch, filter, simd);
+		Image level;
+		linearToImage(next, srgb, level, simd);
+		levels.push_back(level);
+		std::swap(current, next);
+	}
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+
+// Command line switches
+// ---------------------
+struct LaunchOptions
+{
+	bool benchMeshing = false;
+	bool benchCulling = false;
+	bool benchRenderQueue = false;
+	bool benchMips = false;
+	bool benchTransforms = false;
+	bool benchJobs = false;
+	bool cookTextures = false;
+	bool cookUncompressed = false;
+	bool uncapped = false;
+	// Render offscreen without a window for a fixed number of frames
+	bool headless = false;
+	int frames = 600;
+	// Directory to write every headless frame to as PPM, null to skip
+	const char* dumpFrames = nullptr;
+	// Play the scripted camera path over --frames frames and write timings as JSON
+	bool benchCamera = false;
+	const char* benchOutput = "bench_camera.json";
+	// Side of the cube grid and voxel floor, 0 keeps the defaults
+	unsigned int gridSize = 0;
+	// chunks, instanced or cubes, null keeps the default
+	const char* renderMode = nullptr;
+	// Capture this many frames with the profiler and write a Chrome trace, 0 to skip
+	unsigned int profileFrames = 0;
+	const char* profileOutput = "profile.json";
+	// Write every input event and frame time to a log, or play one back in place of live input
+	const char* recordInput = nullptr;
+	const char* replayInput = nullptr;
+};
+
+// Returns false if an argument was not recognised
+inline bool parseOptions(int argc, char** argv, LaunchOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--bench-meshing") == 0)
+			options.benchMeshing = true;
+		else if (std::strcmp(argv[i], "--bench-culling") == 0)
+			options.benchCulling = true;
+		else if (std::strcmp(argv[i], "--bench-queue") == 0)
+			options.benchRenderQueue = true;
+		else if (std::strcmp(argv[i], "--bench-mips") == 0)
+			options.benchMips = true;
+		else if (std::strcmp(argv[i], "--bench-transforms") == 0)
+			options.benchTransforms = true;
+		else if (std::strcmp(argv[i], "--bench-jobs") == 0)
+			options.benchJobs = true;
+		else if (std::strcmp(argv[i], "--cook-textures") == 0)
+			options.cookTextures = true;
+		else if (std::strcmp(argv[i], "--cook-uncompressed") == 0)
+			options.cookTextures = options.cookUncompressed = true;
+		else if (std::strcmp(argv[i], "--uncapped") == 0)
+			options.uncapped = true;
+		else if (std::strcmp(argv[i], "--headless") == 0)
+			options.headless = true;
+		else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+			options.frames = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--dump-frames") == 0 && i + 1 < argc)
+			options.dumpFrames = argv[++i];
+		else if (std::strcmp(argv[i], "--bench-camera") == 0)
+			options.benchCamera = true;
+		else if (std::strcmp(argv[i], "--bench-output") == 0 && i + 1 < argc)
+			options.benchOutput = argv[++i];
+		else if (std::strcmp(argv[i], "--grid") == 0 && i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+			options.gridSize = (unsigned int)std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--render-mode") == 0 && i + 1 < argc)
+			options.renderMode = argv[++i];
+		else if (std::strcmp(argv[i], "--profile-frames") == 0 && i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+			options.profileFrames = (unsigned int)std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--profile-output") == 0 && i + 1 < argc)
+			options.profileOutput = argv[++i];
+		else if (std::strcmp(argv[i], "--record-input") == 0 && i + 1 < argc)
+			options.recordInput = argv[++i];
+		else if (std::strcmp(argv[i], "--replay-input") == 0 && i + 1 < argc)
+			options.replayInput = argv[++i];
+		else
+		{
+			std::cout << "Unknown option " << argv[i] << std::endl;
+			std::cout << "Usage: OpenGL UNO [--bench-meshing] [--bench-culling] [--bench-queue] [--bench-mips] [--bench-transforms] [--bench-jobs] [--cook-textures] [--cook-uncompressed] [--uncapped]"
+				" [--headless [--frames N] [--dump-frames DIR]] [--bench-camera [--bench-output FILE]] [--grid N]"
+				" [--render-mode chunks|instanced|cubes] [--profile-frames N [--profile-output FILE]]"
+				" [--record-input FILE | --replay-input FILE]" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+#endif
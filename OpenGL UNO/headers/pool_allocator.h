@@ -0,0 +1,211 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <vector>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-size blocks carved out of pages. Freed blocks go on an intrusive free
+// list and are handed out again first, so a pool that has reached its working
+// size stops touching the heap. Not thread safe.
+// ---------------------------------------------------------------------------
+class BlockPool
+{
+public:
+	BlockPool(size_t blockBytes, size_t blockAlignment = alignof(std::max_align_t), unsigned int blocksPerPage = 256)
+		: alignment(blockAlignment), perPage(blocksPerPage > 0 ? blocksPerPage : 1), freeList(nullptr), live(0), total(0)
+	{
+		// Every block has to hold the free list link and keep the next block aligned
+		size_t size = blockBytes > sizeof(FreeBlock) ? blockBytes : sizeof(FreeBlock);
+		if (alignment < alignof(FreeBlock))
+			alignment = alignof(FreeBlock);
+		stride = (size + alignment - 1) / alignment * alignment;
+	}
+	~BlockPool()
+	{
+		for (void* page : pages)
+			::operator delete(page);
+	}
+	BlockPool(const BlockPool&) = delete;
+	BlockPool& operator=(const BlockPool&) = delete;
+
+	void* allocate()
+	{
+		if (!freeList)
+			addPage();
+		FreeBlock* block = freeList;
+		freeList = block->next;
+		live++;
+		return block;
+	}
+	void deallocate(void* pointer)
+	{
+		if (!pointer)
+			return;
+		FreeBlock* block = (FreeBlock*)pointer;
+		block->next = freeList;
+		freeList = block;
+		live--;
+	}
+	// Allocate pages up front for at least blockCount blocks
+	void reserve(unsigned int blockCount)
+	{
+		while (total < blockCount)
+			addPage();
+	}
+
+	size_t blockSize() const
+	{
+		return stride;
+	}
+	size_t blockAlignment() const
+	{
+		return alignment;
+	}
+	unsigned int liveCount() const
+	{
+		return live;
+	}
+	unsigned int capacity() const
+	{
+		return total;
+	}
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	size_t alignment;
+	size_t stride;
+	unsigned int perPage;
+	FreeBlock* freeList;
+	unsigned int live;
+	unsigned int total;
+	std::vector<void*> pages;
+
+	void addPage()
+	{
+		// Over-allocate by the alignment so the first block can be aligned by hand
+		char* page = (char*)::operator new(stride * perPage + alignment);
+		pages.push_back(page);
+		char* first = (char*)(((uintptr_t)page + alignment - 1) & ~(uintptr_t)(alignment - 1));
+		for (unsigned int i = perPage; i > 0; i--)
+		{
+			FreeBlock* block = (FreeBlock*)(first + (i - 1) * stride);
+			block->next = freeList;
+			freeList = block;
+		}
+		total += perPage;
+	}
+};
+
+// Engine objects of one type, constructed in pool blocks
+// ------------------------------------------------------
+template <typename T>
+class ObjectPool
+{
+public:
+	ObjectPool(unsigned int objectsPerPage = 64)
+		: blocks(sizeof(T), alignof(T), objectsPerPage)
+	{
+	}
+
+	template <typename... Args>
+	T* create(Args&&... args)
+	{
+		void* block = blocks.allocate();
+		try
+		{
+			return new (block) T(std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			blocks.deallocate(block);
+			throw;
+		}
+	}
+	void destroy(T* object)
+	{
+		if (!object)
+			return;
+		object->~T();
+		blocks.deallocate(object);
+	}
+
+	void reserve(unsigned int objectCount)
+	{
+		blocks.reserve(objectCount);
+	}
+	unsigned int liveCount() const
+	{
+		return blocks.liveCount();
+	}
+
+private:
+	BlockPool blocks;
+};
+
+// STL allocator for node based containers (std::list, std::map,
+// std::unordered_map nodes). Single objects that fit a block come from the
+// pool, anything else, such as a hash table's bucket array, from the heap.
+//
+//   BlockPool nodes(64);
+//   std::map<int, float, std::less<int>, PoolAllocator<std::pair<const int, float>>> map(nodes);
+// -----------------------------------------------------------------------------------------------
+template <typename T>
+class PoolAllocator
+{
+public:
+	typedef T value_type;
+
+	PoolAllocator(BlockPool& source)
+		: pool(&source)
+	{
+	}
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>& other)
+		: pool(other.pool)
+	{
+	}
+
+	T* allocate(size_t count)
+	{
+		if (fitsBlock(count))
+			return (T*)pool->allocate();
+		return (T*)::operator new(count * sizeof(T));
+	}
+	void deallocate(T* pointer, size_t count)
+	{
+		if (fitsBlock(count))
+			pool->deallocate(pointer);
+		else
+			::operator delete(pointer);
+	}
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U>& other) const
+	{
+		return pool == other.pool;
+	}
+	template <typename U>
+	bool operator!=(const PoolAllocator<U>& other) const
+	{
+		return pool != other.pool;
+	}
+
+private:
+	template <typename U>
+	friend class PoolAllocator;
+	BlockPool* pool;
+
+	bool fitsBlock(size_t count) const
+	{
+		return count == 1 && sizeof(T) <= pool->blockSize() && alignof(T) <= pool->blockAlignment();
+	}
+};
+
+#endif
@@ -0,0 +1,361 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Scoped CPU and GPU markers exported as a Chrome trace (chrome://tracing or
+// ui.perfetto.dev). Define UNO_PROFILER to compile the profiler in, without it
+// every marker expands to nothing.
+//
+//   PROFILE_SCOPE("Culling");         CPU time of the enclosing scope
+//   PROFILE_GPU_SCOPE("Draw");        GPU time of the GL commands in the scope
+//   PROFILE_THREAD_NAME("Worker");    Label the calling thread in the trace
+// -----------------------------------------------------------------------------
+#ifdef UNO_PROFILER
+
+#include "gpu_timer.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler::get().setThreadName(name)
+
+// Names must be string literals, only the pointer is stored
+struct ProfileEvent
+{
+	const char* name;
+	uint64_t start;
+	uint64_t end;
+};
+
+// Events of one thread. Only the owning thread writes, it publishes each
+// event by bumping count, so the exporter never needs a lock.
+// ----------------------------------------------------------------------
+struct ProfileThreadBuffer
+{
+	static const uint32_t CAPACITY = 1u << 16;
+
+	unsigned int threadIndex;
+	std::string name;
+	// Capture the events belong to, the owner clears the buffer when it changes
+	std::atomic<uint32_t> generation;
+	std::atomic<uint32_t> count;
+	std::atomic<uint32_t> dropped;
+	ProfileEvent events[CAPACITY];
+
+	ProfileThreadBuffer(unsigned int index)
+		: threadIndex(index), generation(0), count(0), dropped(0)
+	{
+	}
+};
+
+class Profiler
+{
+public:
+	static const unsigned int GPU_QUERY_RING = 64;
+
+	static Profiler& get()
+	{
+		static Profiler profiler;
+		return profiler;
+	}
+
+	// Nanoseconds since the profiler was first used
+	uint64_t now() const
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+	bool recording() const
+	{
+		return active.load(std::memory_order_relaxed);
+	}
+
+	// Record the next frameCount frames, call on the GL thread between frames
+	// -----------------------------------------------------------------------
+	void beginCapture(unsigned int frameCount)
+	{
+		if (!gpuQueries)
+			gpuQueries.reset(new GpuTimer(GPU_QUERY_RING));
+		gpuEvents.clear();
+		gpuDropped = 0;
+		remainingFrames = frameCount;
+		complete = false;
+		captureStart = frameStart = now();
+		generation.fetch_add(1);
+		active.store(frameCount > 0);
+	}
+	// Call at the end of every frame on the GL thread, after its scopes have
+	// closed. Records the frame itself and returns true on the frame that
+	// completes a capture.
+	// -----------------------------------------------------------------------
+	bool endFrame()
+	{
+		if (!recording())
+			return false;
+		uint64_t frameEnd = now();
+		recordCpu("Frame", frameStart, frameEnd);
+		frameStart = frameEnd;
+		collectGpu(false);
+		if (--remainingFrames > 0)
+			return false;
+		active.store(false);
+		// The capture is over, waiting here no longer skews anything
+		collectGpu(true);
+		complete = true;
+		return true;
+	}
+	bool captureComplete() const
+	{
+		return complete;
+	}
+	// Release the GL queries while the context is still current, call on the
+	// GL thread before it is destroyed. The next capture creates them again.
+	void shutdown()
+	{
+		active.store(false);
+		gpuQueries.reset();
+	}
+
+	// Buffer of the calling thread, created on first use
+	ProfileThreadBuffer& threadBuffer()
+	{
+		thread_local ProfileThreadBuffer* buffer = nullptr;
+		if (!buffer)
+		{
+			std::lock_guard<std::mutex> lock(registryMutex);
+			threads.push_back(std::unique_ptr<ProfileThreadBuffer>(new ProfileThreadBuffer((unsigned int)threads.size())));
+			buffer = threads.back().get();
+		}
+		return *buffer;
+	}
+	void setThreadName(const char* name)
+	{
+		ProfileThreadBuffer& buffer = threadBuffer();
+		std::lock_guard<std::mutex> lock(registryMutex);
+		buffer.name = name;
+	}
+
+	void recordCpu(const char* name, uint64_t start, uint64_t end)
+	{
+		ProfileThreadBuffer& buffer = threadBuffer();
+		uint32_t current = generation.load(std::memory_order_acquire);
+		if (buffer.generation.load(std::memory_order_relaxed) != current)
+		{
+			buffer.count.store(0, std::memory_order_relaxed);
+			buffer.dropped.store(0, std::memory_order_relaxed);
+			buffer.generation.store(current, std::memory_order_release);
+		}
+		uint32_t index = buffer.count.load(std::memory_order_relaxed);
+		if (index >= ProfileThreadBuffer::CAPACITY)
+		{
+			buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		ProfileEvent& event = buffer.events[index];
+		event.name = name;
+		event.start = start;
+		event.end = end;
+		buffer.count.store(index + 1, std::memory_order_release);
+	}
+
+	// GPU scopes cannot nest, GL_TIME_ELAPSED allows one active query. When
+	// another timer is running or every query in the ring is still in flight
+	// the sample is dropped rather than waited for.
+	// -----------------------------------------------------------------------
+	bool beginGpu(const char* name)
+	{
+		if (!recording() || gpuOpen)
+			return false;
+		collectGpu(false);
+		int tag = (int)(gpuIssued % GPU_QUERY_RING);
+		if (!gpuQueries->begin(tag))
+		{
+			gpuDropped++;
+			return false;
+		}
+		PendingGpu& pending = gpuPending[tag];
+		pending.name = name;
+		pending.start = now();
+		gpuIssued++;
+		gpuOpen = true;
+		return true;
+	}
+	void endGpu()
+	{
+		gpuQueries->end();
+		gpuOpen = false;
+	}
+
+	// Write the last capture in the Chrome trace event format
+	// -------------------------------------------------------
+	bool writeChromeTrace(const char* path)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (!file)
+		{
+			std::cout << "ERROR::PROFILER::WRITE_FAILED " << path << std::endl;
+			return false;
+		}
+		file.setf(std::ios::fixed);
+		file.precision(3);
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool first = true;
+		size_t cpuEvents = 0, dropped = gpuDropped;
+		uint32_t current = generation.load();
+		{
+			std::lock_guard<std::mutex> lock(registryMutex);
+			for (const std::unique_ptr<ProfileThreadBuffer>& buffer : threads)
+			{
+				std::string name = buffer->name.empty() ? "Thread " + std::to_string(buffer->threadIndex) : buffer->name;
+				writeMetadata(file, first, buffer->threadIndex, name.c_str());
+				if (buffer->generation.load(std::memory_order_acquire) != current)
+					continue;
+				uint32_t count = buffer->count.load(std::memory_order_acquire);
+				dropped += buffer->dropped.load(std::memory_order_relaxed);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					const ProfileEvent& event = buffer->events[i];
+					if (event.start < captureStart)
+						continue;
+					writeEvent(file, first, event, buffer->threadIndex);
+					cpuEvents++;
+				}
+			}
+		}
+		// GPU events go on their own track, placed at the CPU time they were issued
+		const unsigned int gpuTrack = 1000;
+		writeMetadata(file, first, gpuTrack, "GPU");
+		for (const ProfileEvent& event : gpuEvents)
+			writeEvent(file, first, event, gpuTrack);
+		file << "\n]}\n";
+
+		std::cout << "Profiler: wrote " << cpuEvents << " CPU and " << gpuEvents.size() << " GPU events to " << path;
+		if (dropped > 0)
+			std::cout << ", " << dropped << " dropped";
+		std::cout << std::endl;
+		return (bool)file;
+	}
+
+private:
+	struct PendingGpu
+	{
+		const char* name;
+		uint64_t start;
+	};
+
+	std::chrono::steady_clock::time_point epoch;
+	std::atomic<bool> active;
+	std::atomic<uint32_t> generation;
+	uint64_t captureStart = 0;
+	uint64_t frameStart = 0;
+	unsigned int remainingFrames = 0;
+	bool complete = false;
+
+	std::mutex registryMutex;
+	std::vector<std::unique_ptr<ProfileThreadBuffer>> threads;
+
+	// GL thread only, created with the first capture so the profiler can be
+	// used on other threads before a context exists
+	std::unique_ptr<GpuTimer> gpuQueries;
+	PendingGpu gpuPending[GPU_QUERY_RING];
+	std::vector<ProfileEvent> gpuEvents;
+	uint64_t gpuIssued = 0;
+	size_t gpuDropped = 0;
+	bool gpuOpen = false;
+
+	Profiler()
+		: epoch(std::chrono::steady_clock::now()), active(false), generation(0)
+	{
+	}
+
+	void collectGpu(bool wait)
+	{
+		int tag;
+		double milliseconds;
+		while (gpuQueries && gpuQueries->collect(tag, milliseconds, wait))
+		{
+			ProfileEvent event;
+			event.name = gpuPending[tag].name;
+			event.start = gpuPending[tag].start;
+			event.end = event.start + (uint64_t)(milliseconds * 1.0e6);
+			gpuEvents.push_back(event);
+		}
+	}
+
+	static void writeMetadata(std::ofstream& file, bool& first, unsigned int track, const char* name)
+	{
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track
+			<< ",\"args\":{\"name\":\"" << name << "\"}}";
+		first = false;
+	}
+	static void writeEvent(std::ofstream& file, bool& first, const ProfileEvent& event, unsigned int track)
+	{
+		uint64_t end = event.end > event.start ? event.end : event.start;
+		file << (first ? "" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << track
+			<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << (end - event.start) / 1000.0 << "}";
+		first = false;
+	}
+};
+
+// CPU time from construction to destruction
+class ProfileScope
+{
+public:
+	ProfileScope(const char* scopeName)
+		: name(scopeName), recording(Profiler::get().recording()), start(recording ? Profiler::get().now() : 0)
+	{
+	}
+	~ProfileScope()
+	{
+		if (recording)
+			Profiler::get().recordCpu(name, start, Profiler::get().now());
+	}
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* name;
+	bool recording;
+	uint64_t start;
+};
+
+// GPU time of the commands issued in the scope, GL thread only
+class GpuProfileScope
+{
+public:
+	GpuProfileScope(const char* name)
+		: timing(Profiler::get().beginGpu(name))
+	{
+	}
+	~GpuProfileScope()
+	{
+		if (timing)
+			Profiler::get().endGpu();
+	}
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+	bool timing;
+};
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include "file_cache.h"
+#include "gl_extensions.h"
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+// Linked program binaries keyed by the shader sources and the driver that
+// produced them. A driver update changes the key, a stale or foreign binary
+// is rejected by glProgramBinary and the caller compiles from source instead.
+// ---------------------------------------------------------------------------
+const char PROGRAM_CACHE_MAGIC[4] = { 'U', 'N', 'O', 'P' };
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+struct ProgramBinaryHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t binaryFormat;
+	uint32_t length;
+	uint64_t key;
+};
+
+// Binaries need GL 4.1 or ARB_get_program_binary and at least one format
+inline bool programBinariesSupported()
+{
+	if (!glExtensions().programBinaries)
+		return false;
+	int formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return formats > 0;
+}
+
+// Hash of the sources and the vendor, renderer and version strings
+inline uint64_t programCacheKey(const std::string& vertexCode, const std::string& fragmentCode)
+{
+	uint64_t key = hashBytes(vertexCode.data(), vertexCode.size());
+	// Separator so moving text between the stages changes the key
+	key = hashBytes("\0", 1, key);
+	key = hashBytes(fragmentCode.data(), fragmentCode.size(), key);
+	const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+	for (GLenum name : strings)
+	{
+		const char* value = (const char*)glGetString(name);
+		if (value)
+			key = hashBytes(value, std::strlen(value), key);
+	}
+	return key;
+}
+
+inline std::string programCachePath(uint64_t key)
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+	return std::string(CACHE_DIRECTORY) + "/" + name + ".program";
+}
+
+// Returns true if the program was linked from a cached binary
+// -----------------------------------------------------------
+inline bool loadProgramBinary(unsigned int program, uint64_t key)
+{
+	std::ifstream file(programCachePath(key).c_str(), std::ios::binary);
+	if (!file)
+		return false;
+	ProgramBinaryHeader header;
+	if (!file.read((char*)&header, sizeof(header)) || std::memcmp(header.magic, PROGRAM_CACHE_MAGIC, 4) != 0
+		|| header.version != PROGRAM_CACHE_VERSION || header.key != key || header.length == 0)
+		return false;
+	std::vector<char> binary(header.length);
+	if (!file.read(binary.data(), header.length))
+		return false;
+
+	glExtensions().programBinary(program, header.binaryFormat, binary.data(), (GLsizei)header.length);
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	return success != 0;
+}
+
+// Store a linked program, it must have been linked with the retrievable hint
+// --------------------------------------------------------------------------
+inline void saveProgramBinary(unsigned int program, uint64_t key)
+{
+	int length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+	std::vector<char> binary(length);
+	GLenum binaryFormat = 0;
+	glExtensions().getProgramBinary(program, length, &length, &binaryFormat, binary.data());
+	if (length <= 0)
+		return;
+
+	ProgramBinaryHeader header;
+	std::memcpy(header.magic, PROGRAM_CACHE_MAGIC, 4);
+	header.version = PROGRAM_CACHE_VERSION;
+	header.binaryFormat = binaryFormat;
+	header.length = (uint32_t)length;
+	header.key = key;
+
+	makeDirectory(CACHE_DIRECTORY);
+	std::ofstream file(programCachePath(key).c_str(), std::ios::binary | std::ios::trunc);
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), length);
+}
+
+#endif
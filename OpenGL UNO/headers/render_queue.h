@@ -0,0 +1,352 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "shader.h"
+#include "gl_state.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+
+// 64-bit draw sort key, most significant field first:
+// pass (4) | shader (8) | texture set (12) | mesh (16) | depth (24)
+// -----------------------------------------------------------------
+namespace SortKey
+{
+	const unsigned int DEPTH_BITS   = 24;
+	const unsigned int MESH_BITS    = 16;
+	const unsigned int TEXTURE_BITS = 12;
+	const unsigned int SHADER_BITS  = 8;
+	const unsigned int PASS_BITS    = 4;
+
+	const unsigned int DEPTH_SHIFT   = 0;
+	const unsigned int MESH_SHIFT    = DEPTH_SHIFT + DEPTH_BITS;
+	const unsigned int TEXTURE_SHIFT = MESH_SHIFT + MESH_BITS;
+	const unsigned int SHADER_SHIFT  = TEXTURE_SHIFT + TEXTURE_BITS;
+	const unsigned int PASS_SHIFT    = SHADER_SHIFT + SHADER_BITS;
+
+	constexpr uint64_t field(uint64_t key, unsigned int shift, unsigned int bits)
+	{
+		return (key >> shift) & ((1ull << bits) - 1);
+	}
+	constexpr uint64_t make(unsigned int pass, unsigned int shader, unsigned int textureSet, unsigned int mesh, unsigned int depth)
+	{
+		return ((uint64_t)(pass       & ((1u << PASS_BITS) - 1))    << PASS_SHIFT)
+		     | ((uint64_t)(shader     & ((1u << SHADER_BITS) - 1))  << SHADER_SHIFT)
+		     | ((uint64_t)(textureSet & ((1u << TEXTURE_BITS) - 1)) << TEXTURE_SHIFT)
+		     | ((uint64_t)(mesh       & ((1u << MESH_BITS) - 1))    << MESH_SHIFT)
+		     | ((uint64_t)(depth      & ((1u << DEPTH_BITS) - 1))   << DEPTH_SHIFT);
+	}
+	// Quantize a view distance, near first for opaque passes and far first for blended ones
+	inline unsigned int depth(float distance, float maxDistance, bool backToFront = false)
+	{
+		float t = distance / maxDistance;
+		t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+		unsigned int quantized = (unsigned int)(t * (float)((1u << DEPTH_BITS) - 1));
+		return backToFront ? ((1u << DEPTH_BITS) - 1) - quantized : quantized;
+	}
+}
+
+// Render passes in submission order
+enum RenderPass
+{
+	PASS_OPAQUE = 0,
+	PASS_TRANSPARENT = 1
+};
+
+// Draw packets of one frame, sorted by key. Scene code fills a list and a
+// RenderQueue executes it, so the list can be built on one thread and drawn
+// on another. Storage is allocated up front, so clear/submit/sort never allocate.
+// Packets carry an index into a matrix table the caller keeps alive and passes
+// to RenderQueue::execute, instead of a copy of their model matrix.
+// ------------------------------------------------------------------------------
+class DrawList
+{
+public:
+	static const unsigned int NO_TRANSFORM = 0xFFFFFFFFu;
+
+	DrawList(unsigned int packetCapacity = 0)
+		: capacity(0), count(0), droppedPackets(0)
+	{
+		reserve(packetCapacity);
+	}
+
+	void reserve(unsigned int packetCapacity)
+	{
+		capacity = packetCapacity;
+		keys.resize(capacity);
+		values.resize(capacity);
+		scratchKeys.resize(capacity);
+		scratchValues.resize(capacity);
+		if (count > capacity)
+			count = capacity;
+	}
+
+	void clear()
+	{
+		count = 0;
+		droppedPackets = 0;
+	}
+	void submit(uint64_t key)
+	{
+		push(key, NO_TRANSFORM);
+	}
+	void submit(uint64_t key, unsigned int transform)
+	{
+		push(key, transform);
+	}
+	void sort()
+	{
+		radixSort(keys.data(), values.data(), scratchKeys.data(), scratchValues.data(), count);
+	}
+
+	unsigned int size() const
+	{
+		return count;
+	}
+	// Packets lost to a full list since the last clear
+	unsigned int dropped() const
+	{
+		return droppedPackets;
+	}
+	const uint64_t* sortedKeys() const
+	{
+		return keys.data();
+	}
+	// Transform table index of a sorted packet, NO_TRANSFORM for packets submitted without one
+	unsigned int transform(unsigned int index) const
+	{
+		return values[index];
+	}
+
+	// LSD radix sort on bytes, skipping bytes that are equal across all keys
+	// ----------------------------------------------------------------------
+	static void radixSort(uint64_t* keys, unsigned int* values, uint64_t* scratchKeys, unsigned int* scratchValues, unsigned int count)
+	{
+		unsigned int histograms[8][256];
+		std::memset(histograms, 0, sizeof(histograms));
+		for (unsigned int i = 0; i < count; i++)
+		{
+			uint64_t key = keys[i];
+			for (unsigned int byte = 0; byte < 8; byte++)
+				histograms[byte][(key >> (byte * 8)) & 0xFF]++;
+		}
+
+		uint64_t* sourceKeys = keys;
+		unsigned int* sourceValues = values;
+		uint64_t* destinationKeys = scratchKeys;
+		unsigned int* destinationValues = scratchValues;
+		for (unsigned int byte = 0; byte < 8; byte++)
+		{
+			unsigned int* histogram = histograms[byte];
+			// Every key has the same byte here, this pass would not reorder anything
+			if (count == 0 || histogram[(sourceKeys[0] >> (byte * 8)) & 0xFF] == count)
+				continue;
+
+			unsigned int offset = 0;
+			for (unsigned int bucket = 0; bucket < 256; bucket++)
+			{
+				unsigned int bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+			for (unsigned int i = 0; i < count; i++)
+			{
+				unsigned int destination = histogram[(sourceKeys[i] >> (byte * 8)) & 0xFF]++;
+				destinationKeys[destination] = sourceKeys[i];
+				destinationValues[destination] = sourceValues[i];
+			}
+			std::swap(sourceKeys, destinationKeys);
+			std::swap(sourceValues, destinationValues);
+		}
+		// An odd number of passes leaves the result in the scratch buffers
+		if (sourceKeys != keys)
+		{
+			std::memcpy(keys, sourceKeys, count * sizeof(uint64_t));
+			std::memcpy(values, sourceValues, count * sizeof(unsigned int));
+		}
+	}
+
+private:
+	unsigned int capacity;
+	unsigned int count;
+	unsigned int droppedPackets;
+	std::vector<uint64_t> keys;
+	std::vector<unsigned int> values;
+	std::vector<uint64_t> scratchKeys;
+	std::vector<unsigned int> scratchValues;
+
+	void push(uint64_t key, unsigned int value)
+	{
+		if (count == capacity)
+		{
+			droppedPackets++;
+			return;
+		}
+		keys[count] = key;
+		values[count] = value;
+		count++;
+	}
+};
+
+// Resource tables the sort key IDs index into, and the walk that turns a sorted
+// DrawList into draw calls with minimal state changes. Lives on the GL thread.
+// -----------------------------------------------------------------------------
+class RenderQueue
+{
+public:
+	static const unsigned int MAX_TEXTURE_UNITS = 4;
+
+	struct ShaderEntry
+	{
+		Shader* shader;
+		// Invalid for instanced permutations, which read an attribute instead
+		Uniform<glm::mat4> model;
+	};
+	struct TextureSetEntry
+	{
+		GLenum target;
+		unsigned int textures[MAX_TEXTURE_UNITS];
+	};
+	struct MeshEntry
+	{
+		unsigned int VAO;
+		unsigned int indexCount;
+		// 0 for a plain draw, otherwise the instance count of an instanced draw
+		unsigned int instanceCount;
+	};
+	struct Stats
+	{
+		unsigned int packets = 0;
+		unsigned int dropped = 0;
+		unsigned int shaderChanges = 0;
+		unsigned int textureChanges = 0;
+		unsigned int meshChanges = 0;
+	};
+
+	// Persistent resource tables, IDs go into the sort key
+	unsigned int registerShader(Shader* shader)
+	{
+		ShaderEntry entry;
+		entry.shader = shader;
+		entry.model = shader->uniform<glm::mat4>("model");
+		shaders.push_back(entry);
+		return (unsigned int)shaders.size() - 1;
+	}
+	unsigned int registerTextureSet(GLenum target, const unsigned int* textures, unsigned int textureCount)
+	{
+		TextureSetEntry entry;
+		entry.target = target;
+		for (unsigned int i = 0; i < MAX_TEXTURE_UNITS; i++)
+			entry.textures[i] = i < textureCount ? textures[i] : 0;
+		textureSets.push_back(entry);
+		return (unsigned int)textureSets.size() - 1;
+	}
+	unsigned int registerMesh(unsigned int VAO, unsigned int indexCount, unsigned int instanceCount = 0)
+	{
+		MeshEntry entry = { VAO, indexCount, instanceCount };
+		meshes.push_back(entry);
+		return (unsigned int)meshes.size() - 1;
+	}
+	void updateMesh(unsigned int mesh, unsigned int VAO, unsigned int indexCount, unsigned int instanceCount = 0)
+	{
+		MeshEntry entry = { VAO, indexCount, instanceCount };
+		meshes[mesh] = entry;
+	}
+
+	// Issue the sorted packets, returns the number of draw calls. Packets with a
+	// transform index draw with that matrix from transforms, the rest with identity.
+	unsigned int execute(const DrawList& list, const glm::mat4* transforms = nullptr)
+	{
+		beginStats(list);
+		const glm::mat4 identity(1.0f);
+		const uint64_t* keys = list.sortedKeys();
+		uint64_t lastShader = ~0ull, lastTextures = ~0ull, lastMesh = ~0ull;
+		ShaderEntry* shader = nullptr;
+		const MeshEntry* mesh = nullptr;
+		for (unsigned int i = 0; i < list.size(); i++)
+		{
+			uint64_t key = keys[i];
+			uint64_t shaderID = SortKey::field(key, SortKey::SHADER_SHIFT, SortKey::SHADER_BITS);
+			uint64_t textureID = SortKey::field(key, SortKey::TEXTURE_SHIFT, SortKey::TEXTURE_BITS);
+			uint64_t meshID = SortKey::field(key, SortKey::MESH_SHIFT, SortKey::MESH_BITS);
+			if (shaderID != lastShader)
+			{
+				shader = &shaders[shaderID];
+				shader->shader->use();
+				lastShader = shaderID;
+				stats.shaderChanges++;
+			}
+			if (textureID != lastTextures)
+			{
+				const TextureSetEntry& set = textureSets[textureID];
+				for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+					if (set.textures[unit])
+						glState().bindTexture(unit, set.target, set.textures[unit]);
+				lastTextures = textureID;
+				stats.textureChanges++;
+			}
+			if (meshID != lastMesh)
+			{
+				mesh = &meshes[meshID];
+				glState().bindVertexArray(mesh->VAO);
+				lastMesh = meshID;
+				stats.meshChanges++;
+			}
+
+			unsigned int transform = list.transform(i);
+			shader->shader->setMat4(shader->model, transform == DrawList::NO_TRANSFORM ? identity : transforms[transform]);
+			if (mesh->instanceCount > 0)
+				glDrawElementsInstanced(GL_TRIANGLES, mesh->indexCount, GL_UNSIGNED_INT, 0, mesh->instanceCount);
+			else
+				glDrawElements(GL_TRIANGLES, mesh->indexCount, GL_UNSIGNED_INT, 0);
+		}
+		return list.size();
+	}
+	// Walk the sorted packets like execute() without touching GL
+	unsigned int countStateChanges(const DrawList& list)
+	{
+		beginStats(list);
+		const uint64_t* keys = list.sortedKeys();
+		uint64_t lastShader = ~0ull, lastTextures = ~0ull, lastMesh = ~0ull;
+		for (unsigned int i = 0; i < list.size(); i++)
+		{
+			uint64_t key = keys[i];
+			uint64_t shaderID = SortKey::field(key, SortKey::SHADER_SHIFT, SortKey::SHADER_BITS);
+			uint64_t textureID = SortKey::field(key, SortKey::TEXTURE_SHIFT, SortKey::TEXTURE_BITS);
+			uint64_t meshID = SortKey::field(key, SortKey::MESH_SHIFT, SortKey::MESH_BITS);
+			stats.shaderChanges += shaderID != lastShader;
+			stats.textureChanges += textureID != lastTextures;
+			stats.meshChanges += meshID != lastMesh;
+			lastShader = shaderID;
+			lastTextures = textureID;
+			lastMesh = meshID;
+		}
+		return stats.shaderChanges + stats.textureChanges + stats.meshChanges;
+	}
+
+	// Counters of the last executed or counted list
+	const Stats& frameStats() const
+	{
+		return stats;
+	}
+
+private:
+	std::vector<ShaderEntry> shaders;
+	std::vector<TextureSetEntry> textureSets;
+	std::vector<MeshEntry> meshes;
+	Stats stats;
+
+	void beginStats(const DrawList& list)
+	{
+		stats = Stats();
+		stats.packets = list.size();
+		stats.dropped = list.dropped();
+	}
+};
+
+#endif
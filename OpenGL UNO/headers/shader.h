@@ -1,117 +1,362 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include "gl_state.h"
+#include "gl_extensions.h"
+#include "program_cache.h"
+#include "shader_source.h"
+
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <vector>
+#include <cstring>
 #include <iostream>
 
+// Fixed binding points for uniform blocks shared between programs
+// ---------------------------------------------------------------
+enum UniformBlockBinding
+{
+	CAMERA_BLOCK_BINDING = 0
+};
+
+// When a program's compile and link results are collected
+// --------------------------------------------------------
+enum ShaderBuildMode
+{
+	// Compile, link and reflect before the constructor returns
+	SHADER_BUILD_NOW,
+	// Only submit the work, the results are collected on first use
+	SHADER_BUILD_DEFERRED
+};
+
+// Typed handle to an active uniform, resolved once after linking
+// --------------------------------------------------------------
+template <typename T>
+struct Uniform
+{
+	int slot = -1;
+	bool valid() const { return slot >= 0; }
+};
+
 class Shader
 {
 public:
 	// Program ID
 	unsigned int ID;
+	// True if the program was linked from a cached binary instead of source
+	bool loadedFromCache = false;
+	// Features compiled into this permutation
+	const ShaderKey key;
 
 	// Constructor reads and builds shader
 	// -----------------------------------
-	Shader(const char* vertexPath, const char* fragmentPath)
-	{
-		// 1. Retrieve the vertex/fragment source code from file path
-		std::string vertexCode;
-		std::string fragmentCode;
-		std::ifstream vShaderFile;
-		std::ifstream fShaderFile;
-		// Ensure ifstream objects can throw exceptions
-		vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		try
+	Shader(const char* vertexPath, const char* fragmentPath, ShaderBuildMode mode = SHADER_BUILD_NOW, ShaderKey permutation = 0)
+		: key(permutation)
+	{
+		// 1. Retrieve the vertex/fragment source code, with includes and feature defines expanded
+		std::string vertexCode = loadShaderSource(vertexPath, permutation);
+		std::string fragmentCode = loadShaderSource(fragmentPath, permutation);
+		// 2. Link from the binary cache, or submit compile and link
+		build(vertexCode, fragmentCode);
+		if (mode == SHADER_BUILD_NOW)
+			finish();
+	}
+	~Shader()
+	{
+		if (pending && !loadedFromCache)
+			deleteStages();
+		glDeleteProgram(ID);
+	}
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+
+	// True once finish() would not have to wait for the driver. Without
+	// GL_KHR_parallel_shader_compile a deferred build only reports ready
+	// after it has been finished.
+	bool ready() const
+	{
+		if (!pending || loadedFromCache)
+			return true;
+		if (!glExtensions().parallelShaderCompile)
+			return false;
+		int complete = 0;
+		glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+		return complete != 0;
+	}
+	// Collect the link result, cache the binary and reflect uniforms.
+	// Blocks until the driver is done, called implicitly on first use.
+	// ----------------------------------------------------------------
+	void finish()
+	{
+		if (!pending)
+			return;
+		pending = false;
+		if (!loadedFromCache)
 		{
-			// Open files
-			vShaderFile.open(vertexPath);
-			fShaderFile.open(fragmentPath);
-			std::stringstream vShaderStream, fShaderStream;
-			// Read files buffer contents into streams
-			vShaderStream << vShaderFile.rdbuf();
-			fShaderStream << fShaderFile.rdbuf();
-			// Close file handlers
-			vShaderFile.close();
-			fShaderFile.close();
-			// Convert stream into string
-			vertexCode = vShaderStream.str();
-			fragmentCode = fShaderStream.str();
+			// Print compile and linking errors if any
+			int success;
+			char infoLog[512];
+			glGetProgramiv(ID, GL_LINK_STATUS, &success);
+			if (!success)
+			{
+				reportCompileErrors(vertexStage, "VERTEX");
+				reportCompileErrors(fragmentStage, "FRAGMENT");
+				glGetProgramInfoLog(ID, 512, NULL, infoLog);
+				std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+			}
+			else if (cacheKey != 0)
+			{
+				saveProgramBinary(ID, cacheKey);
+			}
+			deleteStages();
 		}
-		catch(std::ifstream::failure e)
+
+		// 3. Reflect active uniforms and attach shared blocks
+		reflectUniforms();
+		bindUniformBlock("Camera", CAMERA_BLOCK_BINDING);
+	}
+	// Use/activate shader
+	void use()
+	{
+		finish();
+		glState().useProgram(ID);
+	}
+	// Look up a typed uniform handle, invalid if the uniform is not active
+	template <typename T>
+	Uniform<T> uniform(const std::string& name)
+	{
+		finish();
+		Uniform<T> handle;
+		handle.slot = findSlot(name);
+		if (handle.valid() && !typeMatches<T>(uniforms[handle.slot].type))
 		{
-			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+			std::cout << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH " << name << std::endl;
+			handle.slot = -1;
 		}
-		const char* vShaderCode = vertexCode.c_str();
-		const char* fShaderCode = fragmentCode.c_str();
+		return handle;
+	}
+	// utility uniform functions
+	// Values are cached per uniform, unchanged values skip the GL call.
+	// The program must be in use when a value actually changes.
+	void setBool(Uniform<bool> handle, bool value)
+	{
+		int v = (int)value;
+		if (changed(handle.slot, &v, sizeof(v)))
+			glUniform1i(uniforms[handle.slot].location, v);
+	}
+	void setInt(Uniform<int> handle, int value)
+	{
+		if (changed(handle.slot, &value, sizeof(value)))
+			glUniform1i(uniforms[handle.slot].location, value);
+	}
+	void setFloat(Uniform<float> handle, float value)
+	{
+		if (changed(handle.slot, &value, sizeof(value)))
+			glUniform1f(uniforms[handle.slot].location, value);
+	}
+	void setVec3(Uniform<glm::vec3> handle, const glm::vec3& value)
+	{
+		if (changed(handle.slot, &value, sizeof(value)))
+			glUniform3fv(uniforms[handle.slot].location, 1, &value.x);
+	}
+	void setMat4(Uniform<glm::mat4> handle, const glm::mat4& value)
+	{
+		if (changed(handle.slot, &value, sizeof(value)))
+			glUniformMatrix4fv(uniforms[handle.slot].location, 1, GL_FALSE, &value[0][0]);
+	}
+	// Name based setters, resolved through the reflected table
+	void setBool(const std::string& name, bool value)
+	{
+		setBool(uniform<bool>(name), value);
+	}
+	void setInt(const std::string& name, int value)
+	{
+		setInt(uniform<int>(name), value);
+	}
+	void setFloat(const std::string& name, float value)
+	{
+		setFloat(uniform<float>(name), value);
+	}
+	void setVec3(const std::string& name, const glm::vec3& value)
+	{
+		setVec3(uniform<glm::vec3>(name), value);
+	}
+	void setMat4(const std::string& name, const glm::mat4& value)
+	{
+		setMat4(uniform<glm::mat4>(name), value);
+	}
 
-		// 2. Compile shaders
-		unsigned int vertex, fragment;
-		int success;
-		char infoLog[512];
+private:
+	// Set until finish() has collected the build results
+	bool pending = false;
+	unsigned int vertexStage = 0;
+	unsigned int fragmentStage = 0;
+	// Program binary cache key, 0 when binaries are not supported
+	uint64_t cacheKey = 0;
 
-		// Vertex Shader
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vShaderCode, NULL);
-		glCompileShader(vertex);
-		// Print compile error if any
-		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-		}
-		// Fragment Shader
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fShaderCode, NULL);
-		glCompileShader(fragment);
-		// Print compile error if any
-		glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-		if (!success)
+	// Issue every compile and link call without querying any status, so the
+	// driver is free to work on it in the background
+	// ---------------------------------------------------------------------
+	void build(const std::string& vertexCode, const std::string& fragmentCode)
+	{
+		ID = glCreateProgram();
+		pending = true;
+		cacheKey = programBinariesSupported() ? programCacheKey(vertexCode, fragmentCode) : 0;
+		if (cacheKey != 0 && loadProgramBinary(ID, cacheKey))
 		{
-			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+			loadedFromCache = true;
+			return;
 		}
 
+		vertexStage = compileStage(GL_VERTEX_SHADER, vertexCode);
+		fragmentStage = compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+
 		// Shader program
-		ID = glCreateProgram();
-		glAttachShader(ID, vertex);
-		glAttachShader(ID, fragment);
+		glAttachShader(ID, vertexStage);
+		glAttachShader(ID, fragmentStage);
+		if (cacheKey != 0)
+			glExtensions().programParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		glLinkProgram(ID);
-		// Print linking errors if any
-		glGetProgramiv(ID, GL_LINK_STATUS, &success);
+	}
+	static unsigned int compileStage(GLenum stage, const std::string& code)
+	{
+		const char* source = code.c_str();
+		unsigned int shader = glCreateShader(stage);
+		glShaderSource(shader, 1, &source, NULL);
+		glCompileShader(shader);
+		return shader;
+	}
+	static void reportCompileErrors(unsigned int shader, const char* stageName)
+	{
+		int success;
+		char infoLog[512];
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 		if (!success)
 		{
-			glGetShaderInfoLog(ID, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+			glGetShaderInfoLog(shader, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::" << stageName << "::COMPILATION_FAILED\n" << infoLog << std::endl;
 		}
+	}
+	void deleteStages()
+	{
+		glDetachShader(ID, vertexStage);
+		glDetachShader(ID, fragmentStage);
+		glDeleteShader(vertexStage);
+		glDeleteShader(fragmentStage);
+		vertexStage = fragmentStage = 0;
+	}
 
-		glDeleteShader(vertex);
-		glDeleteShader(fragment);
+	struct UniformInfo
+	{
+		std::string name;
+		int location;
+		GLenum type;
+		bool cached;
+		unsigned char value[sizeof(glm::mat4)];
+	};
+	// Reflected uniforms and an open addressing table of indices into them
+	std::vector<UniformInfo> uniforms;
+	std::vector<int> table;
+
+	static unsigned int hashName(const char* name, size_t length)
+	{
+		// FNV-1a
+		unsigned int hash = 2166136261u;
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= (unsigned char)name[i];
+			hash *= 16777619u;
+		}
+		return hash;
 	}
-	// Use/activate shader
-	void use()
+	void reflectUniforms()
 	{
-		glUseProgram(ID);
+		int count = 0, maxLength = 0;
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		std::vector<char> nameBuffer(maxLength > 0 ? maxLength : 1);
+		uniforms.clear();
+		uniforms.reserve(count);
+		for (int i = 0; i < count; i++)
+		{
+			int length = 0, size = 0;
+			GLenum type;
+			glGetActiveUniform(ID, i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+			int location = glGetUniformLocation(ID, nameBuffer.data());
+			// Uniform block members have no location
+			if (location < 0)
+				continue;
+			UniformInfo info;
+			info.name.assign(nameBuffer.data(), length);
+			// Arrays are reported as "name[0]"
+			if (info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0)
+				info.name.resize(info.name.size() - 3);
+			info.location = location;
+			info.type = type;
+			info.cached = false;
+			uniforms.push_back(info);
+		}
+
+		// Power of two table kept at most half full
+		size_t tableSize = 8;
+		while (tableSize < uniforms.size() * 2)
+			tableSize *= 2;
+		table.assign(tableSize, -1);
+		for (size_t i = 0; i < uniforms.size(); i++)
+		{
+			size_t mask = tableSize - 1;
+			size_t bucket = hashName(uniforms[i].name.c_str(), uniforms[i].name.size()) & mask;
+			while (table[bucket] >= 0)
+				bucket = (bucket + 1) & mask;
+			table[bucket] = (int)i;
+		}
 	}
-	// utility uniform functions
-	void setBool(const std::string& name, bool value) const
+	int findSlot(const std::string& name) const
 	{
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+		if (table.empty())
+			return -1;
+		size_t mask = table.size() - 1;
+		size_t bucket = hashName(name.c_str(), name.size()) & mask;
+		while (table[bucket] >= 0)
+		{
+			if (uniforms[table[bucket]].name == name)
+				return table[bucket];
+			bucket = (bucket + 1) & mask;
+		}
+		return -1;
 	}
-	void setInt(const std::string& name, int value) const
+	void bindUniformBlock(const char* name, unsigned int binding)
 	{
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+		unsigned int index = glGetUniformBlockIndex(ID, name);
+		if (index != GL_INVALID_INDEX)
+			glUniformBlockBinding(ID, index, binding);
 	}
-	void setFloat(const std::string& name, float value) const
+	// Returns true and stores the value if it differs from the cached one
+	bool changed(int slot, const void* value, size_t size)
 	{
-		glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+		if (slot < 0)
+			return false;
+		UniformInfo& info = uniforms[slot];
+		if (info.cached && std::memcmp(info.value, value, size) == 0)
+			return false;
+		std::memcpy(info.value, value, size);
+		info.cached = true;
+		return true;
 	}
-
+	template <typename T>
+	static bool typeMatches(GLenum type);
 };
 
+template <> inline bool Shader::typeMatches<bool>(GLenum type)      { return type == GL_BOOL; }
+template <> inline bool Shader::typeMatches<float>(GLenum type)     { return type == GL_FLOAT; }
+template <> inline bool Shader::typeMatches<glm::vec3>(GLenum type) { return type == GL_FLOAT_VEC3; }
+template <> inline bool Shader::typeMatches<glm::mat4>(GLenum type) { return type == GL_FLOAT_MAT4; }
+template <> inline bool Shader::typeMatches<int>(GLenum type)
+{
+	// Samplers are set through integer texture units
+	return type == GL_INT || type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_3D || type == GL_SAMPLER_CUBE;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,98 @@
+#ifndef SHADER_LIBRARY_H
+#define SHADER_LIBRARY_H
+
+#include "shader.h"
+#include "file_cache.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+// Owns every shader permutation in a flat array sorted by (source, key).
+// Only requested permutations are built. Compile and link calls are submitted
+// before any status is queried, so a driver with GL_KHR_parallel_shader_compile
+// works on them in the background while the rest of the scene loads. Each
+// program finishes on its own first use.
+// ----------------------------------------------------------------------------
+class ShaderLibrary
+{
+public:
+	ShaderLibrary()
+	{
+		// Let the driver pick how many compiler threads to use
+		if (glExtensions().parallelShaderCompile)
+			glExtensions().maxShaderCompilerThreads(0xFFFFFFFFu);
+	}
+	ShaderLibrary(const ShaderLibrary&) = delete;
+	ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+	// Return a permutation, submitting its build the first time it is requested.
+	// The pointer stays valid for the library's lifetime.
+	// -------------------------------------------------------------------------
+	Shader* get(const char* vertexPath, const char* fragmentPath, ShaderKey key = 0)
+	{
+		Entry probe;
+		probe.source = sourceID(vertexPath, fragmentPath);
+		probe.key = key;
+		std::vector<Entry>::iterator it = std::lower_bound(entries.begin(), entries.end(), probe, before);
+		for (; it != entries.end() && it->source == probe.source && it->key == key; ++it)
+			if (it->vertexPath == vertexPath && it->fragmentPath == fragmentPath)
+				return it->shader.get();
+
+		probe.vertexPath = vertexPath;
+		probe.fragmentPath = fragmentPath;
+		probe.shader.reset(new Shader(vertexPath, fragmentPath, SHADER_BUILD_DEFERRED, key));
+		Shader* shader = probe.shader.get();
+		entries.insert(it, std::move(probe));
+		return shader;
+	}
+
+	// Programs whose build can be collected without stalling
+	unsigned int readyCount() const
+	{
+		unsigned int count = 0;
+		for (const Entry& entry : entries)
+			if (entry.shader->ready())
+				count++;
+		return count;
+	}
+	unsigned int size() const
+	{
+		return (unsigned int)entries.size();
+	}
+
+	// Collect every program now, for callers that cannot wait for first use
+	void finishAll()
+	{
+		for (Entry& entry : entries)
+			entry.shader->finish();
+	}
+
+private:
+	struct Entry
+	{
+		uint64_t source;
+		ShaderKey key;
+		std::string vertexPath;
+		std::string fragmentPath;
+		std::unique_ptr<Shader> shader;
+	};
+	std::vector<Entry> entries;
+
+	static uint64_t sourceID(const char* vertexPath, const char* fragmentPath)
+	{
+		uint64_t hash = hashBytes(vertexPath, std::strlen(vertexPath) + 1);
+		return hashBytes(fragmentPath, std::strlen(fragmentPath), hash);
+	}
+	static bool before(const Entry& a, const Entry& b)
+	{
+		return a.source != b.source ? a.source < b.source : a.key < b.key;
+	}
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef SHADER_SOURCE_H
+#define SHADER_SOURCE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+// Optional code paths compiled into a shader permutation. Each feature is
+// injected as a #define, the sources test it with #ifdef.
+// -----------------------------------------------------------------------
+enum ShaderFeature
+{
+	// Model matrix from a per-instance attribute instead of a uniform
+	SHADER_FEATURE_INSTANCED,
+	// Discard fragments with alpha below one half
+	SHADER_FEATURE_ALPHA_TEST,
+	SHADER_FEATURE_COUNT
+};
+
+const char* const SHADER_FEATURE_DEFINES[SHADER_FEATURE_COUNT] = {
+	"INSTANCED",
+	"ALPHA_TEST"
+};
+
+// Bitmask of enabled features identifying a permutation
+typedef unsigned int ShaderKey;
+static_assert(SHADER_FEATURE_COUNT <= 32, "ShaderKey has one bit per feature");
+
+// Build a permutation key at compile time, shaderKey() is the base variant
+constexpr ShaderKey shaderKey()
+{
+	return 0;
+}
+template <typename... Features>
+constexpr ShaderKey shaderKey(ShaderFeature feature, Features... rest)
+{
+	return (1u << feature) | shaderKey(rest...);
+}
+
+inline bool readShaderFile(const std::string& path, std::string& text)
+{
+	std::ifstream file(path.c_str());
+	if (!file)
+		return false;
+	std::stringstream stream;
+	stream << file.rdbuf();
+	text = stream.str();
+	return true;
+}
+
+// Expand #include "file" lines relative to the including file. Every file is
+// included at most once. #line directives carry the index of the file in
+// `files`, so compile errors read <file index>:<line>.
+// ---------------------------------------------------------------------------
+inline bool expandShaderIncludes(const std::string& path, ShaderKey key, std::vector<std::string>& files, std::string& out)
+{
+	std::string text;
+	if (!readShaderFile(path, text))
+	{
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+		return false;
+	}
+	const unsigned int fileIndex = (unsigned int)files.size();
+	files.push_back(path);
+	const std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+
+	std::istringstream lines(text);
+	std::string line;
+	unsigned int lineNumber = 0;
+	while (std::getline(lines, line))
+	{
+		lineNumber++;
+		size_t start = line.find_first_not_of(" \t");
+		if (start != std::string::npos && line.compare(start, 8, "#include") == 0)
+		{
+			size_t open = line.find('"', start);
+			size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+			if (close == std::string::npos)
+			{
+				std::cout << "ERROR::SHADER::MALFORMED_INCLUDE " << path << ":" << lineNumber << std::endl;
+				return false;
+			}
+			std::string includePath = directory + line.substr(open + 1, close - open - 1);
+			bool included = false;
+			for (const std::string& file : files)
+				included = included || file == includePath;
+			if (!included)
+			{
+				out += "#line 1 " + std::to_string(files.size()) + "\n";
+				if (!expandShaderIncludes(includePath, key, files, out))
+					return false;
+			}
+			out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+			continue;
+		}
+
+		out += line;
+		out += '\n';
+		// Feature defines go right after the #version of the root file
+		if (fileIndex == 0 && start != std::string::npos && line.compare(start, 8, "#version") == 0)
+		{
+			for (unsigned int feature = 0; feature < SHADER_FEATURE_COUNT; feature++)
+				if (key & (1u << feature))
+					out += std::string("#define ") + SHADER_FEATURE_DEFINES[feature] + "\n";
+			out += "#line " + std::to_string(lineNumber + 1) + " 0\n";
+		}
+	}
+	return true;
+}
+
+// Source of one permutation of a shader stage, empty if a file failed to load
+inline std::string loadShaderSource(const char* path, ShaderKey key)
+{
+	std::vector<std::string> files;
+	std::string source;
+	if (!expandShaderIncludes(path, key, files, source))
+		return std::string();
+	return source;
+}
+
+#endif
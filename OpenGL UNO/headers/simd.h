@@ -0,0 +1,21 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Pick the widest instruction set the compiler targets. Kernels check
+// UNO_SIMD_AVX2 first, then UNO_SIMD_SSE2, and fall back to scalar code.
+// The Release configurations build with /arch:AVX2 and need an AVX2 CPU,
+// Debug builds keep the SSE2 baseline.
+// -----------------------------------------------------------------------
+#if defined(__AVX2__)
+#define UNO_SIMD_AVX2 1
+#define UNO_SIMD_NAME "AVX2"
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UNO_SIMD_SSE2 1
+#define UNO_SIMD_NAME "SSE2"
+#include <emmintrin.h>
+#else
+#define UNO_SIMD_NAME "scalar"
+#endif
+
+#endif
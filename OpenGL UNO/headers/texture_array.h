@@ -0,0 +1,215 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include "gl_state.h"
+#include "stb_image.h"
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+// Decoded 8-bit image
+// -------------------
+struct Image
+{
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	std::vector<unsigned char> pixels;
+
+	bool load(const char* path, int desiredChannels, bool flipVertically)
+	{
+		// Per thread flag, images are also decoded on worker threads
+		stbi_set_flip_vertically_on_load_thread(flipVertically);
+		int fileChannels;
+		unsigned char* data = stbi_load(path, &width, &height, &fileChannels, desiredChannels);
+		stbi_set_flip_vertically_on_load_thread(false);
+		if (!data)
+			return false;
+		channels = desiredChannels ? desiredChannels : fileChannels;
+		pixels.assign(data, data + (size_t)width * height * channels);
+		stbi_image_free(data);
+		return true;
+	}
+};
+
+// Resample to a new size, averaging the source footprint of each texel.
+// Upscaling degenerates to nearest filtering which keeps pixel art sharp.
+// -----------------------------------------------------------------------
+inline Image resizeImage(const Image& source, int width, int height)
+{
+	Image result;
+	result.width = width;
+	result.height = height;
+	result.channels = source.channels;
+	result.pixels.resize((size_t)width * height * source.channels);
+	for (int y = 0; y < height; y++)
+	{
+		int y0 = y * source.height / height;
+		int y1 = (y + 1) * source.height / height;
+		if (y1 <= y0)
+			y1 = y0 + 1;
+		for (int x = 0; x < width; x++)
+		{
+			int x0 = x * source.width / width;
+			int x1 = (x + 1) * source.width / width;
+			if (x1 <= x0)
+				x1 = x0 + 1;
+			for (int c = 0; c < source.channels; c++)
+			{
+				unsigned int sum = 0;
+				for (int sy = y0; sy < y1; sy++)
+					for (int sx = x0; sx < x1; sx++)
+						sum += source.pixels[((size_t)sy * source.width + sx) * source.channels + c];
+				unsigned int samples = (unsigned int)((y1 - y0) * (x1 - x0));
+				result.pixels[((size_t)y * width + x) * source.channels + c] = (unsigned char)((sum + samples / 2) / samples);
+			}
+		}
+	}
+	return result;
+}
+
+// Place the image in the lower left corner and repeat its edge texels outwards
+// ----------------------------------------------------------------------------
+inline Image padImage(const Image& source, int width, int height)
+{
+	Image result;
+	result.width = width;
+	result.height = height;
+	result.channels = source.channels;
+	result.pixels.resize((size_t)width * height * source.channels);
+	for (int y = 0; y < height; y++)
+	{
+		int sy = y < source.height ? y : source.height - 1;
+		for (int x = 0; x < width; x++)
+		{
+			int sx = x < source.width ? x : source.width - 1;
+			std::memcpy(&result.pixels[((size_t)y * width + x) * source.channels],
+				&source.pixels[((size_t)sy * source.width + sx) * source.channels], source.channels);
+		}
+	}
+	return result;
+}
+
+// Where a material's texture ended up
+struct MaterialSlot
+{
+	unsigned int group;
+	unsigned int layer;
+};
+
+// Collects images and packs them into GL_TEXTURE_2D_ARRAY objects, one per
+// (channel count, layer size) group. With a fixed layer size every image of
+// a format is resized or padded into the same array, so one bind covers them.
+// ---------------------------------------------------------------------------
+class TextureArrayBuilder
+{
+public:
+	enum FitMode
+	{
+		FIT_RESIZE,
+		FIT_PAD
+	};
+
+	struct Group
+	{
+		int channels;
+		int size;
+		unsigned int texture;
+		std::vector<Image> layers;
+	};
+	std::vector<Group> groups;
+
+	// layerSize of 0 groups images by their own size rounded up to a power of two
+	TextureArrayBuilder(int layerSize = 0, FitMode fitMode = FIT_RESIZE)
+		: fixedSize(layerSize), fit(fitMode)
+	{
+	}
+
+	// Load an image and queue it as a layer, returns false if it could not be read
+	bool add(const char* path, int channels, bool flipVertically, MaterialSlot& slot)
+	{
+		Image image;
+		if (!image.load(path, channels, flipVertically))
+		{
+			std::cout << "Failed to load texture " << path << std::endl;
+			return false;
+		}
+		slot = add(image);
+		return true;
+	}
+	MaterialSlot add(const Image& image)
+	{
+		int size = fixedSize;
+		if (size == 0)
+		{
+			size = 1;
+			while (size < image.width || size < image.height)
+				size *= 2;
+		}
+
+		Group& group = findGroup(image.channels, size);
+		if (image.width == size && image.height == size)
+			group.layers.push_back(image);
+		else if (fit == FIT_PAD && image.width <= size && image.height <= size)
+			group.layers.push_back(padImage(image, size, size));
+		else
+			group.layers.push_back(resizeImage(image, size, size));
+
+		MaterialSlot slot;
+		slot.group = (unsigned int)(&group - groups.data());
+		slot.layer = (unsigned int)group.layers.size() - 1;
+		return slot;
+	}
+
+	// Create and upload every array, the CPU copies are released afterwards
+	void build(GLenum wrap, GLenum minFilter, GLenum magFilter)
+	{
+		for (Group& group : groups)
+		{
+			GLenum format = group.channels == 4 ? GL_RGBA : (group.channels == 3 ? GL_RGB : (group.channels == 2 ? GL_RG : GL_RED));
+			GLenum internalFormat = group.channels == 4 ? GL_RGBA8 : (group.channels == 3 ? GL_RGB8 : (group.channels == 2 ? GL_RG8 : GL_R8));
+
+			glGenTextures(1, &group.texture);
+			glState().bindTexture(0, GL_TEXTURE_2D_ARRAY, group.texture);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, minFilter);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, magFilter);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, group.size, group.size, (GLsizei)group.layers.size(),
+				0, format, GL_UNSIGNED_BYTE, NULL);
+			for (size_t layer = 0; layer < group.layers.size(); layer++)
+			{
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, (GLint)layer, group.size, group.size, 1,
+					format, GL_UNSIGNED_BYTE, group.layers[layer].pixels.data());
+			}
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			group.layers.clear();
+			group.layers.shrink_to_fit();
+		}
+	}
+
+private:
+	int fixedSize;
+	FitMode fit;
+
+	Group& findGroup(int channels, int size)
+	{
+		for (Group& group : groups)
+			if (group.channels == channels && group.size == size)
+				return group;
+		Group group;
+		group.channels = channels;
+		group.size = size;
+		group.texture = 0;
+		groups.push_back(group);
+		return groups.back();
+	}
+};
+
+#endif
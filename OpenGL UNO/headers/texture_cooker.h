@@ -0,0 +1,377 @@
+#ifndef TEXTURE_COOKER_H
+#define TEXTURE_COOKER_H
+
+#include "texture_array.h"
+#include "cooked_texture.h"
+#include "materials.h"
+#include "mipmap.h"
+
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// BC1/BC3 block encoding
+// ----------------------
+inline unsigned short packRGB565(int r, int g, int b)
+{
+	return (unsigned short)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+inline void unpackRGB565(unsigned short color, int* rgb)
+{
+	int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Gather a 4x4 RGBA block, clamping at the edges of images smaller than a block
+inline void extractBlock(const Image& image, int blockX, int blockY, unsigned char block[64])
+{
+	for (int y = 0; y < 4; y++)
+	{
+		int sy = blockY * 4 + y < image.height ? blockY * 4 + y : image.height - 1;
+		for (int x = 0; x < 4; x++)
+		{
+			int sx = blockX * 4 + x < image.width ? blockX * 4 + x : image.width - 1;
+			std::memcpy(&block[(y * 4 + x) * 4], &image.pixels[((size_t)sy * image.width + sx) * 4], 4);
+		}
+	}
+}
+
+// Endpoints from the bounding box diagonal that follows the block's colour
+// trend, inset slightly, then the nearest of the four palette entries per texel.
+// Always uses the four colour mode, so it is valid for both BC1 and BC3.
+// ------------------------------------------------------------------------------
+inline void encodeColorBlock(const unsigned char block[64], unsigned char* out)
+{
+	int minColor[3] = { 255, 255, 255 }, maxColor[3] = { 0, 0, 0 };
+	int mean[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			int value = block[i * 4 + c];
+			minColor[c] = value < minColor[c] ? value : minColor[c];
+			maxColor[c] = value > maxColor[c] ? value : maxColor[c];
+			mean[c] += value;
+		}
+	}
+	for (int c = 0; c < 3; c++)
+		mean[c] /= 16;
+
+	// Flip the box diagonal on channels that fall while the widest channel rises
+	int axis = 0;
+	for (int c = 1; c < 3; c++)
+		if (maxColor[c] - minColor[c] > maxColor[axis] - minColor[axis])
+			axis = c;
+	for (int c = 0; c < 3; c++)
+	{
+		if (c == axis)
+			continue;
+		int covariance = 0;
+		for (int i = 0; i < 16; i++)
+			covariance += (block[i * 4 + axis] - mean[axis]) * (block[i * 4 + c] - mean[c]);
+		if (covariance < 0)
+		{
+			int swap = minColor[c];
+			minColor[c] = maxColor[c];
+			maxColor[c] = swap;
+		}
+	}
+	for (int c = 0; c < 3; c++)
+	{
+		int inset = (maxColor[c] - minColor[c]) / 16;
+		maxColor[c] -= inset;
+		minColor[c] += inset;
+	}
+
+	unsigned short color0 = packRGB565(maxColor[0], maxColor[1], maxColor[2]);
+	unsigned short color1 = packRGB565(minColor[0], minColor[1], minColor[2]);
+	unsigned int indices = 0;
+	if (color0 != color1)
+	{
+		// Four colour mode requires color0 > color1
+		if (color0 < color1)
+		{
+			unsigned short swap = color0;
+			color0 = color1;
+			color1 = swap;
+		}
+		int palette[4][3];
+		unpackRGB565(color0, palette[0]);
+		unpackRGB565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestError = 1 << 30;
+			for (int p = 0; p < 4; p++)
+			{
+				int dr = block[i * 4] - palette[p][0], dg = block[i * 4 + 1] - palette[p][1], db = block[i * 4 + 2] - palette[p][2];
+				int error = dr * dr + dg * dg + db * db;
+				if (error < bestError)
+				{
+					bestError = error;
+					best = p;
+				}
+			}
+			indices |= (unsigned int)best << (i * 2);
+		}
+	}
+	out[0] = (unsigned char)(color0 & 0xFF);
+	out[1] = (unsigned char)(color0 >> 8);
+	out[2] = (unsigned char)(color1 & 0xFF);
+	out[3] = (unsigned char)(color1 >> 8);
+	for (int i = 0; i < 4; i++)
+		out[4 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+// BC3 alpha block in the eight value mode, alpha0 > alpha1
+// --------------------------------------------------------
+inline void encodeAlphaBlock(const unsigned char block[64], unsigned char* out)
+{
+	int minAlpha = 255, maxAlpha = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int alpha = block[i * 4 + 3];
+		minAlpha = alpha < minAlpha ? alpha : minAlpha;
+		maxAlpha = alpha > maxAlpha ? alpha : maxAlpha;
+	}
+	unsigned long long indices = 0;
+	if (maxAlpha != minAlpha)
+	{
+		int palette[8];
+		palette[0] = maxAlpha;
+		palette[1] = minAlpha;
+		for (int p = 1; p < 7; p++)
+			palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestError = 1 << 30;
+			for (int p = 0; p < 8; p++)
+			{
+				int error = std::abs(block[i * 4 + 3] - palette[p]);
+				if (error < bestError)
+				{
+					bestError = error;
+					best = p;
+				}
+			}
+			indices |= (unsigned long long)best << (i * 3);
+		}
+	}
+	out[0] = (unsigned char)maxAlpha;
+	out[1] = (unsigned char)minAlpha;
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+// Encode one RGBA8 image, appending the blocks or raw texels to output
+inline void encodeImage(const Image& image, uint32_t format, std::vector<unsigned char>& output)
+{
+	if (format == COOKED_RGBA8)
+	{
+		output.insert(output.end(), image.pixels.begin(), image.pixels.end());
+		return;
+	}
+	unsigned char block[64];
+	unsigned char encoded[16];
+	int blocksX = (image.width + 3) / 4, blocksY = (image.height + 3) / 4;
+	for (int by = 0; by < blocksY; by++)
+	{
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			extractBlock(image, bx, by, block);
+			if (format == COOKED_BC3)
+			{
+				encodeAlphaBlock(block, encoded);
+				encodeColorBlock(block, encoded + 8);
+				output.insert(output.end(), encoded, encoded + 16);
+			}
+			else
+			{
+				encodeColorBlock(block, encoded);
+				output.insert(output.end(), encoded, encoded + 8);
+			}
+		}
+	}
+}
+
+// Decode a BC1/BC3 level back to RGBA8, used to report cooking error
+inline void decodeImage(const unsigned char* data, uint32_t format, int width, int height, std::vector<unsigned char>& pixels)
+{
+	pixels.assign((size_t)width * height * 4, 255);
+	int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	int blockBytes = format == COOKED_BC3 ? 16 : 8;
+	for (int by = 0; by < blocksY; by++)
+	{
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			const unsigned char* block = data + (size_t)(by * blocksX + bx) * blockBytes;
+			int alphas[8];
+			unsigned long long alphaIndices = 0;
+			if (format == COOKED_BC3)
+			{
+				alphas[0] = block[0];
+				alphas[1] = block[1];
+				for (int p = 1; p < 7; p++)
+					alphas[p + 1] = alphas[0] > alphas[1] ? ((7 - p) * alphas[0] + p * alphas[1]) / 7 : alphas[0];
+				for (int i = 0; i < 6; i++)
+					alphaIndices |= (unsigned long long)block[2 + i] << (i * 8);
+				block += 8;
+			}
+			int palette[4][3];
+			unpackRGB565((unsigned short)(block[0] | (block[1] << 8)), palette[0]);
+			unpackRGB565((unsigned short)(block[2] | (block[3] << 8)), palette[1]);
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			unsigned int indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((unsigned int)block[7] << 24);
+			for (int i = 0; i < 16; i++)
+			{
+				int x = bx * 4 + (i & 3), y = by * 4 + (i >> 2);
+				if (x >= width || y >= height)
+					continue;
+				unsigned char* texel = &pixels[((size_t)y * width + x) * 4];
+				const int* color = palette[(indices >> (i * 2)) & 3];
+				texel[0] = (unsigned char)color[0];
+				texel[1] = (unsigned char)color[1];
+				texel[2] = (unsigned char)color[2];
+				if (format == COOKED_BC3)
+					texel[3] = (unsigned char)alphas[(alphaIndices >> (i * 3)) & 7];
+			}
+		}
+	}
+}
+
+// Write a cooked container from the mip chains of equally sized RGBA8
+// layers, chains[layer][level]. Returns the file size, 0 on failure.
+// -------------------------------------------------------------------
+inline uint64_t writeCookedTexture(const char* path, const std::vector<std::vector<Image>>& chains, uint32_t format)
+{
+	if (chains.empty() || chains[0].empty())
+		return 0;
+	uint32_t width = (uint32_t)chains[0][0].width, height = (uint32_t)chains[0][0].height;
+	uint32_t levelCount = (uint32_t)chains[0].size();
+	for (const std::vector<Image>& chain : chains)
+		if (chain.size() != levelCount)
+			return 0;
+
+	CookedTextureHeader header;
+	std::memcpy(header.magic, COOKED_MAGIC, 4);
+	header.version = COOKED_VERSION;
+	header.format = format;
+	header.width = width;
+	header.height = height;
+	header.layers = (uint32_t)chains.size();
+	header.levels = levelCount;
+	header.reserved = 0;
+
+	// Encode every level, each holding all layers back to back
+	std::vector<std::vector<unsigned char>> levelData(levelCount);
+	std::vector<CookedLevel> table(levelCount);
+	uint64_t offset = sizeof(CookedTextureHeader) + levelCount * sizeof(CookedLevel);
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		for (const std::vector<Image>& chain : chains)
+			encodeImage(chain[level], format, levelData[level]);
+		offset = (offset + 15) & ~15ull;
+		table[level].offset = offset;
+		table[level].size = levelData[level].size();
+		table[level].width = (uint32_t)chains[0][level].width;
+		table[level].height = (uint32_t)chains[0][level].height;
+		offset += levelData[level].size();
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return 0;
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)table.data(), table.size() * sizeof(CookedLevel));
+	uint64_t written = sizeof(header) + table.size() * sizeof(CookedLevel);
+	const char padding[16] = {};
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		file.write(padding, (std::streamsize)(table[level].offset - written));
+		file.write((const char*)levelData[level].data(), (std::streamsize)levelData[level].size());
+		written = table[level].offset + table[level].size;
+	}
+	return file ? written : 0;
+}
+
+// Offline cook of the material array, run with --cook-textures
+// ------------------------------------------------------------
+inline int runTextureCooker(bool uncompressed)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	TextureArrayBuilder materials(MATERIAL_LAYER_SIZE);
+	MaterialSlot slot;
+	for (int i = 0; i < MATERIAL_COUNT; i++)
+		if (!materials.add(MATERIAL_SOURCES[i].path, 4, MATERIAL_SOURCES[i].flipVertically, slot))
+			return -1;
+	const std::vector<Image>& layers = materials.groups[0].layers;
+
+	// BC1 carries no alpha, only use BC3 when some layer needs it
+	uint32_t format = COOKED_BC1;
+	for (const Image& layer : layers)
+		for (size_t i = 3; i < layer.pixels.size(); i += 4)
+			if (layer.pixels[i] != 255)
+				format = COOKED_BC3;
+	if (uncompressed)
+		format = COOKED_RGBA8;
+	const char* formatNames[] = { "RGBA8", "BC1", "BC3", "BC7" };
+
+	// Gamma correct mips, every layer tiles so the Kaiser filter wraps
+	std::vector<std::vector<Image>> chains(layers.size());
+	for (size_t layer = 0; layer < layers.size(); layer++)
+		generateMipChain(layers[layer], MIP_FILTER_KAISER, true, chains[layer]);
+	uint64_t fileSize = writeCookedTexture(COOKED_MATERIALS_PATH, chains, format);
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	if (fileSize == 0)
+	{
+		std::cout << "ERROR::TEXTURE_COOKER::WRITE_FAILED " << COOKED_MATERIALS_PATH << std::endl;
+		return -1;
+	}
+
+	// Compare against what the runtime would have uploaded, RGBA8 plus mips
+	uint64_t rawSize = (uint64_t)MATERIAL_LAYER_SIZE * MATERIAL_LAYER_SIZE * 4 * layers.size() * 4 / 3;
+	std::cout << "Cooked " << layers.size() << " layers of " << MATERIAL_LAYER_SIZE << "x" << MATERIAL_LAYER_SIZE
+		<< " as " << formatNames[format] << " to " << COOKED_MATERIALS_PATH << " in " << seconds * 1000.0 << " ms" << std::endl;
+	std::cout << "  " << fileSize / 1024 << " KiB vs " << rawSize / 1024 << " KiB uncompressed ("
+		<< (double)rawSize / fileSize << "x smaller)" << std::endl;
+
+	// Report base level error of the block encoder
+	if (format != COOKED_RGBA8)
+	{
+		CookedTexture cooked;
+		if (!cooked.open(COOKED_MATERIALS_PATH))
+			return -1;
+		std::vector<unsigned char> decoded;
+		for (size_t layer = 0; layer < layers.size(); layer++)
+		{
+			decodeImage(cooked.layerData(0, (uint32_t)layer), format, MATERIAL_LAYER_SIZE, MATERIAL_LAYER_SIZE, decoded);
+			double squaredError = 0.0;
+			for (size_t i = 0; i < decoded.size(); i++)
+			{
+				if ((i & 3) == 3 && format == COOKED_BC1)
+					continue;
+				double difference = (double)decoded[i] - layers[layer].pixels[i];
+				squaredError += difference * difference;
+			}
+			double channels = format == COOKED_BC1 ? 3.0 : 4.0;
+			double mse = squaredError / (MATERIAL_LAYER_SIZE * MATERIAL_LAYER_SIZE * channels);
+			std::cout << "  " << MATERIAL_SOURCES[layer].path << ": PSNR "
+				<< (mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0) << " dB" << std::endl;
+		}
+	}
+	return 0;
+}
+
+#endif
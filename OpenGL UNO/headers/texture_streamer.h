@@ -0,0 +1,316 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include "texture_array.h"
+#include "mip_cache.h"
+#include "gl_state.h"
+#include "profiler.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+// Texture array whose layers are decoded on worker threads and streamed in
+// through a ring of pixel buffer objects. Layers show a placeholder checker
+// until their upload lands, requests can be made at any time.
+// -------------------------------------------------------------------------
+class AsyncTextureManager
+{
+public:
+	// GL_TEXTURE_2D_ARRAY holding every layer
+	unsigned int texture;
+
+	AsyncTextureManager(int layerSize, unsigned int layerCount, unsigned int workerCount = 0, unsigned int uploadSlots = 3)
+		: size(layerSize), layers(layerCount), levels(1), stopping(false), pending(0), cacheHits(0), currentSlot(0)
+	{
+		while ((size >> levels) > 0)
+			levels++;
+		slotSize = 0;
+		for (unsigned int level = 0; level < levels; level++)
+			slotSize += (size_t)levelSize(level) * levelSize(level) * 4;
+
+		createTexture();
+
+		pixelBuffers.resize(uploadSlots);
+		fences.resize(uploadSlots, (GLsync)0);
+		glGenBuffers(uploadSlots, pixelBuffers.data());
+		for (unsigned int slot = 0; slot < uploadSlots; slot++)
+		{
+			glState().bindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[slot]);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, slotSize, NULL, GL_STREAM_DRAW);
+		}
+		glState().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		// Leave a core for the render thread
+		if (workerCount == 0)
+		{
+			unsigned int cores = std::thread::hardware_concurrency();
+			workerCount = cores > 2 ? (cores - 1 < 4 ? cores - 1 : 4) : 1;
+		}
+		for (unsigned int i = 0; i < workerCount; i++)
+			workers.push_back(std::thread(&AsyncTextureManager::workerLoop, this));
+	}
+	~AsyncTextureManager()
+	{
+		{
+			std::lock_guard<std::mutex> lock(jobMutex);
+			stopping = true;
+		}
+		jobReady.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+		for (GLsync fence : fences)
+			if (fence)
+				glDeleteSync(fence);
+		glDeleteBuffers((GLsizei)pixelBuffers.size(), pixelBuffers.data());
+		glDeleteTextures(1, &texture);
+	}
+	AsyncTextureManager(const AsyncTextureManager&) = delete;
+	AsyncTextureManager& operator=(const AsyncTextureManager&) = delete;
+
+	// Queue an image to be decoded into a layer, safe to call mid-session
+	void request(const char* path, bool flipVertically, unsigned int layer)
+	{
+		if (layer >= layers)
+			return;
+		Job job;
+		job.path = path;
+		job.flipVertically = flipVertically;
+		job.layer = layer;
+		pending++;
+		{
+			std::lock_guard<std::mutex> lock(jobMutex);
+			jobs.push_back(job);
+		}
+		jobReady.notify_one();
+	}
+
+	// Stream finished decodes into the texture, call once per frame on the GL thread.
+	// Never blocks: stops early when the next PBO is still being read by the GPU.
+	// -------------------------------------------------------------------------------
+	unsigned int update(unsigned int maxUploads = 2)
+	{
+		PROFILE_SCOPE("Texture uploads");
+		unsigned int uploads = 0;
+		while (uploads < maxUploads)
+		{
+			if (!slotAvailable(currentSlot))
+				break;
+			Result result;
+			{
+				std::lock_guard<std::mutex> lock(resultMutex);
+				if (results.empty())
+					break;
+				result = std::move(results.front());
+				results.pop_front();
+			}
+			pending--;
+			if (result.levels.empty())
+			{
+				std::cout << "ERROR::TEXTURE::LOAD_FAILED " << result.path << std::endl;
+				continue;
+			}
+			if (!fitsSlot(result))
+			{
+				std::cout << "ERROR::TEXTURE::MIP_CHAIN_MISMATCH " << result.path << std::endl;
+				continue;
+			}
+			upload(result);
+			uploads++;
+		}
+		return uploads;
+	}
+
+	// Decodes and uploads still outstanding
+	unsigned int pendingCount() const
+	{
+		return pending.load();
+	}
+	// Layers whose mip chain came from the disk cache
+	unsigned int cacheHitCount() const
+	{
+		return cacheHits.load();
+	}
+
+private:
+	struct Job
+	{
+		std::string path;
+		bool flipVertically;
+		unsigned int layer;
+	};
+	struct Result
+	{
+		std::string path;
+		unsigned int layer;
+		// Full mip chain, empty if the image failed to load
+		std::vector<Image> levels;
+	};
+
+	int size;
+	unsigned int layers;
+	unsigned int levels;
+	size_t slotSize;
+
+	std::vector<std::thread> workers;
+	std::mutex jobMutex;
+	std::condition_variable jobReady;
+	std::deque<Job> jobs;
+	bool stopping;
+
+	std::mutex resultMutex;
+	std::deque<Result> results;
+	std::atomic<unsigned int> pending;
+	std::atomic<unsigned int> cacheHits;
+
+	std::vector<unsigned int> pixelBuffers;
+	std::vector<GLsync> fences;
+	unsigned int currentSlot;
+
+	int levelSize(unsigned int level) const
+	{
+		return (size >> level) > 0 ? size >> level : 1;
+	}
+
+	// Allocate every level and fill all layers with the placeholder
+	// -------------------------------------------------------------
+	void createTexture()
+	{
+		glGenTextures(1, &texture);
+		glState().bindTexture(0, GL_TEXTURE_2D_ARRAY, texture);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint)levels - 1);
+
+		// Magenta and grey checker, 8 tiles across at every level
+		std::vector<unsigned char> placeholder((size_t)size * size * 4);
+		for (unsigned int level = 0; level < levels; level++)
+		{
+			int dimension = levelSize(level);
+			int tile = dimension >= 8 ? dimension / 8 : 1;
+			for (int y = 0; y < dimension; y++)
+			{
+				for (int x = 0; x < dimension; x++)
+				{
+					bool odd = ((x / tile) + (y / tile)) & 1;
+					unsigned char* texel = &placeholder[((size_t)y * dimension + x) * 4];
+					texel[0] = odd ? 255 : 96;
+					texel[1] = odd ? 0 : 96;
+					texel[2] = odd ? 255 : 96;
+					texel[3] = 255;
+				}
+			}
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, dimension, dimension, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			for (unsigned int layer = 0; layer < layers; layer++)
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, dimension, dimension, 1, GL_RGBA, GL_UNSIGNED_BYTE, placeholder.data());
+		}
+	}
+
+	// Decode, fit to the layer size and build the mip chain off the GL thread,
+	// or read the chain from the mip cache
+	// -----------------------------------------------------------------------
+	void workerLoop()
+	{
+		PROFILE_THREAD_NAME("Texture worker");
+		for (;;)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(jobMutex);
+				jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+				if (stopping)
+					return;
+				job = jobs.front();
+				jobs.pop_front();
+			}
+
+			PROFILE_SCOPE("Decode material");
+			Result result;
+			result.path = job.path;
+			result.layer = job.layer;
+			bool cached = false;
+			if (loadMipChain(job.path.c_str(), job.flipVertically, size, MIP_FILTER_KAISER, true, result.levels, &cached) && cached)
+				cacheHits++;
+
+			std::lock_guard<std::mutex> lock(resultMutex);
+			results.push_back(std::move(result));
+		}
+	}
+
+	// A slot is free once the GPU has consumed its last upload
+	bool slotAvailable(unsigned int slot)
+	{
+		GLsync fence = fences[slot];
+		if (!fence)
+			return true;
+		GLenum status = glClientWaitSync(fence, 0, 0);
+		if (status == GL_TIMEOUT_EXPIRED)
+			return false;
+		glDeleteSync(fence);
+		fences[slot] = (GLsync)0;
+		return true;
+	}
+
+	// The upload copies the chain into a slot sized for exactly this texture's levels
+	bool fitsSlot(const Result& result) const
+	{
+		if (result.levels.size() != levels)
+			return false;
+		for (unsigned int level = 0; level < levels; level++)
+		{
+			const Image& image = result.levels[level];
+			int dimension = levelSize(level);
+			if (image.width != dimension || image.height != dimension || image.pixels.size() != (size_t)dimension * dimension * 4)
+				return false;
+		}
+		return true;
+	}
+
+	void upload(const Result& result)
+	{
+		glState().bindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[currentSlot]);
+		unsigned char* mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slotSize,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (mapped)
+		{
+			size_t offset = 0;
+			for (const Image& level : result.levels)
+			{
+				std::memcpy(mapped + offset, level.pixels.data(), level.pixels.size());
+				offset += level.pixels.size();
+			}
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+			// Copies from the bound PBO run asynchronously, offsets replace pointers
+			glState().bindTexture(0, GL_TEXTURE_2D_ARRAY, texture);
+			offset = 0;
+			for (unsigned int level = 0; level < levels; level++)
+			{
+				int dimension = levelSize(level);
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, result.layer, dimension, dimension, 1,
+					GL_RGBA, GL_UNSIGNED_BYTE, (void*)offset);
+				offset += result.levels[level].pixels.size();
+			}
+			fences[currentSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			currentSlot = (currentSlot + 1) % pixelBuffers.size();
+		}
+		else
+		{
+			std::cout << "ERROR::TEXTURE::PBO_MAP_FAILED " << result.path << std::endl;
+		}
+		// Other uploads pass client memory pointers
+		glState().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+};
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef TRANSFORMS_H
+#define TRANSFORMS_H
+
+#include "simd.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+#include <algorithm>
+
+// Position, rotation and scale of many objects stored as structure of
+// arrays, padded to blocks of 8 lanes. update() rebuilds the model matrix
+// (translate * rotate * scale) of every block containing a changed transform,
+// a whole block per SIMD kernel call. Objects that never move are composed
+// once and skipped afterwards.
+// ---------------------------------------------------------------------------
+class TransformList
+{
+public:
+	static const unsigned int BLOCK = 8;
+
+	std::vector<float> positionX, positionY, positionZ;
+	// Unit quaternions
+	std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+	std::vector<float> scaleX, scaleY, scaleZ;
+
+	TransformList()
+		: count(0)
+	{
+	}
+
+	void clear()
+	{
+		count = 0;
+		resizeLanes(0);
+	}
+	void reserve(unsigned int capacity)
+	{
+		unsigned int lanes = (capacity + BLOCK - 1) / BLOCK * BLOCK;
+		for (std::vector<float>* lane : lanesOf())
+			lane->reserve(lanes);
+		matrixList.reserve(lanes);
+		dirtyBlocks.reserve(lanes / BLOCK);
+	}
+	unsigned int add(const glm::vec3& position, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f))
+	{
+		// Overwrite the first padding slot, or grow by a block
+		if (count == positionX.size())
+			resizeLanes(count + BLOCK);
+		unsigned int index = count++;
+		positionX[index] = position.x; positionY[index] = position.y; positionZ[index] = position.z;
+		rotationX[index] = rotation.x; rotationY[index] = rotation.y; rotationZ[index] = rotation.z; rotationW[index] = rotation.w;
+		scaleX[index] = scale.x; scaleY[index] = scale.y; scaleZ[index] = scale.z;
+		markDirty(index);
+		return index;
+	}
+
+	// Setters mark the transform's block for the next update
+	// -------------------------------------------------------
+	void setPosition(unsigned int index, const glm::vec3& position)
+	{
+		positionX[index] = position.x; positionY[index] = position.y; positionZ[index] = position.z;
+		markDirty(index);
+	}
+	void setRotation(unsigned int index, const glm::quat& rotation)
+	{
+		rotationX[index] = rotation.x; rotationY[index] = rotation.y; rotationZ[index] = rotation.z; rotationW[index] = rotation.w;
+		markDirty(index);
+	}
+	void setScale(unsigned int index, const glm::vec3& scale)
+	{
+		scaleX[index] = scale.x; scaleY[index] = scale.y; scaleZ[index] = scale.z;
+		markDirty(index);
+	}
+	glm::vec3 position(unsigned int index) const
+	{
+		return glm::vec3(positionX[index], positionY[index], positionZ[index]);
+	}
+	// Mark every transform, for benchmarks and after editing the arrays directly
+	void markAllDirty()
+	{
+		std::fill(dirtyBlocks.begin(), dirtyBlocks.end(), (unsigned char)1);
+		firstDirtyBlock = 0;
+		endDirtyBlock = (unsigned int)dirtyBlocks.size();
+	}
+
+	unsigned int size() const
+	{
+		return count;
+	}
+	// Number of lanes including identity padding, always a multiple of 8
+	unsigned int paddedSize() const
+	{
+		return (unsigned int)positionX.size();
+	}
+
+	// Model matrices as of the last update, one per lane
+	const glm::mat4& matrix(unsigned int index) const
+	{
+		return matrixList[index];
+	}
+	const glm::mat4* matrices() const
+	{
+		return matrixList.data();
+	}
+
+	// Rebuild the matrices of dirty blocks. Returns the number of blocks
+	// composed, [first, first + changed) covers every matrix that changed
+	// so a caller can upload just that range.
+	// ------------------------------------------------------------------
+	unsigned int update(unsigned int& first, unsigned int& changed)
+	{
+		first = changed = 0;
+		if (firstDirtyBlock >= endDirtyBlock)
+			return 0;
+		unsigned int composed = 0;
+		for (unsigned int block = firstDirtyBlock; block < endDirtyBlock; block++)
+		{
+			if (!dirtyBlocks[block])
+				continue;
+			composeBlock(block * BLOCK);
+			dirtyBlocks[block] = 0;
+			composed++;
+		}
+		first = firstDirtyBlock * BLOCK;
+		unsigned int end = endDirtyBlock * BLOCK < count ? endDirtyBlock * BLOCK : count;
+		changed = end > first ? end - first : 0;
+		firstDirtyBlock = ~0u;
+		endDirtyBlock = 0;
+		return composed;
+	}
+	unsigned int update()
+	{
+		unsigned int first, changed;
+		return update(first, changed);
+	}
+
+	// Scalar glm reference for one transform
+	glm::mat4 composeReference(unsigned int index) const
+	{
+		glm::quat rotation(rotationW[index], rotationX[index], rotationY[index], rotationZ[index]);
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), position(index));
+		model = model * glm::mat4_cast(rotation);
+		return glm::scale(model, glm::vec3(scaleX[index], scaleY[index], scaleZ[index]));
+	}
+
+private:
+	unsigned int count;
+	std::vector<glm::mat4> matrixList;
+	std::vector<unsigned char> dirtyBlocks;
+	// Half open range of blocks that may be dirty, empty when first >= end
+	unsigned int firstDirtyBlock = ~0u;
+	unsigned int endDirtyBlock = 0;
+
+	std::vector<std::vector<float>*> lanesOf()
+	{
+		return { &positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ };
+	}
+	// Padding lanes hold the identity transform, so whole blocks compose safely
+	void resizeLanes(unsigned int size)
+	{
+		positionX.resize(size, 0.0f); positionY.resize(size, 0.0f); positionZ.resize(size, 0.0f);
+		rotationX.resize(size, 0.0f); rotationY.resize(size, 0.0f); rotationZ.resize(size, 0.0f); rotationW.resize(size, 1.0f);
+		scaleX.resize(size, 1.0f); scaleY.resize(size, 1.0f); scaleZ.resize(size, 1.0f);
+		matrixList.resize(size, glm::mat4(1.0f));
+		dirtyBlocks.resize(size / BLOCK, 0);
+	}
+	void markDirty(unsigned int index)
+	{
+		unsigned int block = index / BLOCK;
+		dirtyBlocks[block] = 1;
+		if (block < firstDirtyBlock)
+			firstDirtyBlock = block;
+		if (block + 1 > endDirtyBlock)
+			endDirtyBlock = block + 1;
+	}
+
+	// Compose the 8 transforms starting at first. Each column of 4 or 8
+	// matrices is built across lanes, then transposed into glm::mat4 columns.
+	// -----------------------------------------------------------------------
+	void composeBlock(unsigned int first)
+	{
+#if defined(UNO_SIMD_AVX2)
+		const __m256 one = _mm256_set1_ps(1.0f);
+		__m256 x = _mm256_loadu_ps(&rotationX[first]);
+		__m256 y = _mm256_loadu_ps(&rotationY[first]);
+		__m256 z = _mm256_loadu_ps(&rotationZ[first]);
+		__m256 w = _mm256_loadu_ps(&rotationW[first]);
+		__m256 x2 = _mm256_add_ps(x, x), y2 = _mm256_add_ps(y, y), z2 = _mm256_add_ps(z, z);
+		__m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+		__m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+		__m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+		__m256 sx = _mm256_loadu_ps(&scaleX[first]);
+		__m256 sy = _mm256_loadu_ps(&scaleY[first]);
+		__m256 sz = _mm256_loadu_ps(&scaleZ[first]);
+		__m256 columns[4][4] = {
+			{ _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_add_ps(xy, wz), sx), _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), _mm256_setzero_ps() },
+			{ _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy), _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), _mm256_setzero_ps() },
+			{ _mm256_mul_ps(_mm256_add_ps(xz, wy), sz), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), _mm256_setzero_ps() },
+			{ _mm256_loadu_ps(&positionX[first]), _mm256_loadu_ps(&positionY[first]), _mm256_loadu_ps(&positionZ[first]), one }
+		};
+		// Unpacks and shuffles work within each 128-bit half, so one transpose
+		// yields the column of matrix i in the low half and of i + 4 in the high
+		glm::mat4* out = &matrixList[first];
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			__m256 xy0 = _mm256_unpacklo_ps(columns[column][0], columns[column][1]);
+			__m256 zw0 = _mm256_unpacklo_ps(columns[column][2], columns[column][3]);
+			__m256 xy1 = _mm256_unpackhi_ps(columns[column][0], columns[column][1]);
+			__m256 zw1 = _mm256_unpackhi_ps(columns[column][2], columns[column][3]);
+			__m256 transposed[4] = {
+				_mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(3, 2, 3, 2)),
+				_mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(3, 2, 3, 2))
+			};
+			for (unsigned int i = 0; i < 4; i++)
+			{
+				_mm_storeu_ps(&out[i][column][0], _mm256_castps256_ps128(transposed[i]));
+				_mm_storeu_ps(&out[i + 4][column][0], _mm256_extractf128_ps(transposed[i], 1));
+			}
+		}
+#elif defined(UNO_SIMD_SSE2)
+		const __m128 one = _mm_set1_ps(1.0f);
+		for (unsigned int lane = first; lane < first + BLOCK; lane += 4)
+		{
+			__m128 x = _mm_loadu_ps(&rotationX[lane]);
+			__m128 y = _mm_loadu_ps(&rotationY[lane]);
+			__m128 z = _mm_loadu_ps(&rotationZ[lane]);
+			__m128 w = _mm_loadu_ps(&rotationW[lane]);
+			__m128 x2 = _mm_add_ps(x, x), y2 = _mm_add_ps(y, y), z2 = _mm_add_ps(z, z);
+			__m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+			__m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+			__m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+			__m128 sx = _mm_loadu_ps(&scaleX[lane]);
+			__m128 sy = _mm_loadu_ps(&scaleY[lane]);
+			__m128 sz = _mm_loadu_ps(&scaleZ[lane]);
+			__m128 columns[4][4] = {
+				{ _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx), _mm_mul_ps(_mm_sub_ps(xz, wy), sx), _mm_setzero_ps() },
+				{ _mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy), _mm_mul_ps(_mm_add_ps(yz, wx), sy), _mm_setzero_ps() },
+				{ _mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), _mm_setzero_ps() },
+				{ _mm_loadu_ps(&positionX[lane]), _mm_loadu_ps(&positionY[lane]), _mm_loadu_ps(&positionZ[lane]), one }
+			};
+			glm::mat4* out = &matrixList[lane];
+			for (unsigned int column = 0; column < 4; column++)
+			{
+				__m128 cx = columns[column][0], cy = columns[column][1], cz = columns[column][2], cw = columns[column][3];
+				_MM_TRANSPOSE4_PS(cx, cy, cz, cw);
+				_mm_storeu_ps(&out[0][column][0], cx);
+				_mm_storeu_ps(&out[1][column][0], cy);
+				_mm_storeu_ps(&out[2][column][0], cz);
+				_mm_storeu_ps(&out[3][column][0], cw);
+			}
+		}
+#else
+		for (unsigned int lane = first; lane < first + BLOCK; lane++)
+			matrixList[lane] = composeReference(lane);
+#endif
+	}
+};
+
+#endif
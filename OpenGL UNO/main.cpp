@@ -1,5 +1,34 @@
 #include "headers/shader.h"
+#include "headers/shader_library.h"
+#include "headers/gl_state.h"
+#include "headers/gl_extensions.h"
 #include "headers/stb_image.h"
+#include "headers/texture_array.h"
+#include "headers/cooked_texture.h"
+#include "headers/texture_cooker.h"
+#include "headers/materials.h"
+#include "headers/texture_streamer.h"
+#include "headers/instance_buffer.h"
+#include "headers/transforms.h"
+#include "headers/camera_ubo.h"
+#include "headers/camera.h"
+#include "headers/mesh_optimizer.h"
+#include "headers/chunk.h"
+#include "headers/frustum.h"
+#include "headers/render_queue.h"
+#include "headers/frame_ring.h"
+#include "headers/frame_arena.h"
+#include "headers/allocation_tracker.h"
+#include "headers/game_loop.h"
+#include "headers/options.h"
+#include "headers/benchmarks.h"
+#include "headers/frame_timer.h"
+#include "headers/headless_context.h"
+#include "headers/framebuffer.h"
+#include "headers/camera_benchmark.h"
+#include "headers/input_log.h"
+#include "headers/profiler.h"
+#include "headers/file_cache.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -8,74 +37,233 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <algorithm>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow* window);
+void processInput(GLFWwindow* window, float tickSeconds);
+void updateJump();
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void handleCursor(double xpos, double ypos);
+void handleScroll(double xoffset, double yoffset);
+void handleKey(int key, int scancode, int action, int mods);
 
 // Window
 const unsigned int WIDTH  = 1920;
 const unsigned int HEIGHT = 1080;
 
 // Camera
-glm::vec3 cameraPos   = glm::vec3(0.0f, 0.0f, 3.0f);
-glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
-glm::vec3 cameraUp    = glm::vec3(0.0f, 1.0f, 0.0f);
+Camera camera(glm::vec3(0.0f, 0.0f, 3.0f), -90.0f, 0.0f, 45.0f);
 float lastX = 400, lastY = 300;
-float yaw = -90.0f;
-float pitch = 0.0f;
-float fov = 45.0f;
 bool firstMouse = true;
 
+// Input, live events are recorded and replayed events stand in for them
+KeyState keys;
+InputLog inputLog;
+const InputHandlers inputHandlers = { handleKey, handleCursor, handleScroll };
+
 // Timing
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
+double deltaTime = 0.0;
+double lastFrame = 0.0;
+FixedTimestep timestep(60.0);
+double simulationTime = 0.0;
 
 // Jump
-float firstJump;
-float currentJump;
+double firstJump;
 bool isJumping = false;
 
-bool togglePolygon = false;
+bool wireframe = false;
+bool reloadMaterials = false;
 
-int main() {
-	
-	// Initialize & Configure GLFW
-	// ---------------------------
-	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-	// Create GLFW window
-	// ------------------
-	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Goat Coder", NULL, NULL);
-	if (window == NULL)
+// Rendering, --grid overrides both sizes
+const unsigned int GRID_SIZE = 20;
+const int WORLD_SIZE = 512;
+enum RenderMode
+{
+	RENDER_CHUNKS,
+	RENDER_INSTANCED,
+	RENDER_PER_CUBE
+};
+const char* renderModeNames[] = { "Chunks", "Instanced", "Per-cube" };
+// Moved floor matrices handed to the render thread per frame, a larger move
+// is spread over the following frames
+const unsigned int MOVED_MATRICES_PER_FRAME = 1024;
+// Values accepted by --render-mode
+const char* renderModeOptions[] = { "chunks", "instanced", "cubes" };
+RenderMode renderMode = RENDER_CHUNKS;
+
+// Everything the render thread needs to draw one frame. The main thread fills
+// a slot of the frame ring, the render thread consumes it a frame later.
+// ---------------------------------------------------------------------------
+struct RenderFrame
+{
+	int index = 0;
+	double frameSeconds = 0.0;
+	RenderMode renderMode = RENDER_CHUNKS;
+	bool wireframe = false;
+	bool reloadMaterials = false;
+	int viewportWidth = 0;
+	int viewportHeight = 0;
+
+	// Camera block contents, only valid when cameraChanged is set
+	bool cameraChanged = false;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 eye;
+
+	// Floor instance matrices that moved, written from instanceFirst on
+	unsigned int instanceFirst = 0;
+	unsigned int instanceCount = 0;
+	const glm::mat4* instanceMatrices = nullptr;
+
+	DrawList drawList;
+	// Variable sized frame data, reset when the main thread takes the slot again
+	LinearArena arena;
+};
+
+int main(int argc, char** argv) {
+
+	LaunchOptions options;
+	if (!parseOptions(argc, argv, options))
+		return -1;
+	if (options.benchMeshing)
+		return runMeshingBenchmark();
+	if (options.benchCulling)
+		return runCullingBenchmark();
+	if (options.benchRenderQueue)
+		return runRenderQueueBenchmark();
+	if (options.benchMips)
+		return runMipmapBenchmark();
+	if (options.benchTransforms)
+		return runTransformBenchmark();
+	if (options.benchJobs)
+		return runJobBenchmark();
+	if (options.cookTextures)
+		return runTextureCooker(options.cookUncompressed);
+
+	// Scene parameters
+	const unsigned int gridSize = options.gridSize ? options.gridSize : GRID_SIZE;
+	const int worldSize = options.gridSize ? (int)options.gridSize : WORLD_SIZE;
+	if (options.renderMode)
 	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
+		int mode = 0;
+		while (mode < 3 && std::strcmp(options.renderMode, renderModeOptions[mode]) != 0)
+			mode++;
+		if (mode == 3)
+		{
+			std::cout << "Unknown render mode " << options.renderMode << std::endl;
+			return -1;
+		}
+		renderMode = (RenderMode)mode;
+	}
+
+	// Record or replay input, replayed runs also replay the recorded frame times
+	if (options.recordInput && !inputLog.record(options.recordInput))
 		return -1;
+	if (options.replayInput && !inputLog.replay(options.replayInput))
+		return -1;
+
+	// Headless runs use a surfaceless EGL context where there is one, and a
+	// hidden window elsewhere. Either way they draw into an offscreen framebuffer.
+	// ---------------------------------------------------------------------------
+	HeadlessContext headlessContext;
+	GLFWwindow* window = NULL;
+	// GLFW is terminated when main returns. Declared ahead of every GL object so
+	// their destructors still run with the window's context alive.
+	struct GlfwSession
+	{
+		bool initialized = false;
+		~GlfwSession()
+		{
+			if (initialized)
+				glfwTerminate();
+		}
+	} glfwSession;
+	if (options.headless && HeadlessContext::available())
+	{
+		if (!headlessContext.create(3, 3))
+			return -1;
+	}
+	else
+	{
+		// Initialize & Configure GLFW
+		// ---------------------------
+		glfwInit();
+		glfwSession.initialized = true;
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		if (options.headless)
+		{
+			std::cout << "Headless: no EGL on this platform, rendering through a hidden window, which needs a display" << std::endl;
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		}
+
+		// Create GLFW window
+		// ------------------
+		window = glfwCreateWindow(WIDTH, HEIGHT, "Goat Coder", NULL, NULL);
+		if (window == NULL)
+		{
+			std::cout << "Failed to create GLFW window" << std::endl;
+			return -1;
+		}
+		glfwMakeContextCurrent(window);
+		// Benchmark runs render as fast as possible, the simulation rate is unaffected
+		glfwSwapInterval(options.uncapped || options.headless ? 0 : 1);
+		glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+		glfwSetCursorPosCallback(window, mouse_callback);
+		glfwSetScrollCallback(window, scroll_callback);
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+		glfwSetKeyCallback(window, key_callback);
 	}
-	glfwMakeContextCurrent(window);
-	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-	glfwSetCursorPosCallback(window, mouse_callback);
-	glfwSetScrollCallback(window, scroll_callback);
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-	glfwSetKeyCallback(window, key_callback);
 
 	// GLAD: load all opengl function pointers
 	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	GLADloadproc loader = window ? (GLADloadproc)glfwGetProcAddress : (GLADloadproc)HeadlessContext::getProcAddress;
+	if (!gladLoadGLLoader(loader))
 	{
 		std::cout << "Failed to initialize GLAD" << std::endl;
 		return -1;
 	}
+	glExtensions().load(loader);
+
+	// Reversed-Z with an infinite far plane where clip control is available,
+	// it keeps depth precise far beyond the old 100 unit far plane
+	const bool reversedZ = glExtensions().clipControl;
+	int framebufferWidth = WIDTH, framebufferHeight = HEIGHT;
+	if (window)
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	camera.setViewport(framebufferWidth, framebufferHeight);
+	camera.setProjectionMode(reversedZ ? PROJECTION_REVERSED_INFINITE : PROJECTION_STANDARD);
+
+	// Headless frames go to an offscreen target of the window's size. Windowed
+	// reversed-Z frames render offscreen too for a floating point depth buffer,
+	// and are copied to the window before each swap.
+	std::unique_ptr<Framebuffer> sceneTarget;
+	if (options.headless || reversedZ)
+		sceneTarget.reset(new Framebuffer(framebufferWidth, framebufferHeight, reversedZ ? GL_DEPTH32F_STENCIL8 : GL_DEPTH24_STENCIL8));
+	if (options.headless)
+	{
+		if (options.dumpFrames)
+			makeDirectory(options.dumpFrames);
+		std::cout << "Headless: rendering " << options.frames << " frames offscreen at " << WIDTH << "x" << HEIGHT << std::endl;
+	}
 
-	// Build and compile shader program
-	// --------------------------------
-	Shader ourShader("shaders/shader.vs", "shaders/shader.fs");
+	// Submit every shader permutation, the driver compiles them while the scene loads
+	// ------------------------------------------------------------------------------
+	double shaderStart = monotonicSeconds();
+	ShaderLibrary shaders;
+	Shader& ourShader = *shaders.get("shaders/shader.vs", "shaders/shader.fs");
+	Shader& instancedShader = *shaders.get("shaders/shader.vs", "shaders/shader.fs", shaderKey(SHADER_FEATURE_INSTANCED));
+	std::cout << "Submitted " << shaders.size() << " shader programs in "
+		<< (monotonicSeconds() - shaderStart) * 1000.0 << " ms" << std::endl;
 
 	// Set up vertex data & buffers, and configure vertex attributes
 	// -------------------------------------------------------------
@@ -141,12 +329,28 @@ int main() {
 	glGenBuffers(1, &VBO);
 	glGenBuffers(1, &EBO);
 
+	// Deduplicate the cube and reorder its triangles for vertex cache reuse
+	// --------------------------------------------------------------------
+	const unsigned int expandedCount = sizeof(verticies) / (5 * sizeof(float));
+	std::vector<unsigned int> expandedIndices(expandedCount);
+	for (unsigned int i = 0; i < expandedCount; i++)
+		expandedIndices[i] = i;
+	IndexedMesh cubeMesh = buildIndexedMesh(verticies, expandedCount, 5);
+	float indexedACMR = computeACMR(cubeMesh.indices, cubeMesh.vertexCount());
+	optimizeVertexCache(cubeMesh.indices, cubeMesh.vertexCount());
+	std::cout << "Cube mesh: " << expandedCount << " -> " << cubeMesh.vertexCount() << " vertices, ACMR "
+		<< computeACMR(expandedIndices, expandedCount) << " (expanded) -> " << indexedACMR << " (indexed) -> "
+		<< computeACMR(cubeMesh.indices, cubeMesh.vertexCount()) << " (optimized)" << std::endl;
+	const unsigned int cubeIndexCount = (unsigned int)cubeMesh.indices.size();
+
 	// First triangle VAO setup
 	// ------------------------
 	glBindVertexArray(VAO);
 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verticies), verticies, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, cubeMesh.vertices.size() * sizeof(float), cubeMesh.vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, cubeMesh.indices.size() * sizeof(unsigned int), cubeMesh.indices.data(), GL_STATIC_DRAW);
 
 	// Position attribute
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
@@ -155,177 +359,496 @@ int main() {
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 	glEnableVertexAttribArray(1);
 
-	// Load texture file and create texture object
-	// -------------------------------------------
-	unsigned int texture[3];
-	glGenTextures(3, texture);
-
-	// Texture 1
-	// ---------
-	glBindTexture(GL_TEXTURE_2D, texture[0]);
-	// Set texture wrapping options of currently bound texture object
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	// Load and generate texture
-	int width, height, nrChannels;
-	unsigned char* data = stbi_load("textures/container.jpg", &width, &height, &nrChannels, 0);
-	if (data)
+	// Floor grid transforms, composed and uploaded once. The per-cube path
+	// reads the same matrices, only transforms that move are recomposed.
+	// Per-cube packets index this table from the render thread, so the floor
+	// has to stay put while frames are in flight.
+	// ----------------------------------------------------------------------
+	InstanceBuffer floorInstances;
+	floorInstances.attach(VAO, 2);
+	TransformList floorTransforms;
+	floorTransforms.reserve(gridSize * gridSize);
+	for (unsigned int n = 0; n < gridSize; n++)
+	{
+		for (unsigned int i = 0; i < gridSize; i++)
+		{
+			floorTransforms.add(glm::vec3((float)i, -2.0f, (float)n));
+		}
+	}
+	floorTransforms.update();
+	floorInstances.upload(floorTransforms.matrices(), floorTransforms.size());
+
+	// Material texture array, from the cooked container when present and
+	// otherwise decoded on worker threads while the first frames render
+	// ------------------------------------------------------------------
+	double materialStart = monotonicSeconds();
+	unsigned int materialTexture = 0;
+	CookedTexture cookedMaterials;
+	std::unique_ptr<AsyncTextureManager> streamedMaterials;
+	if (cookedMaterials.open(COOKED_MATERIALS_PATH) && cookedMaterials.info().layers == MATERIAL_COUNT)
+		materialTexture = cookedMaterials.createTexture(GL_TEXTURE_2D_ARRAY, GL_REPEAT, GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST);
+	if (materialTexture)
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		std::cout << "Loaded cooked materials in " << (monotonicSeconds() - materialStart) * 1000.0 << " ms" << std::endl;
 	}
 	else
 	{
-		std::cout << "Failed to load texture" << std::endl;
+		streamedMaterials.reset(new AsyncTextureManager(MATERIAL_LAYER_SIZE, MATERIAL_COUNT));
+		for (int i = 0; i < MATERIAL_COUNT; i++)
+			streamedMaterials->request(MATERIAL_SOURCES[i].path, MATERIAL_SOURCES[i].flipVertically, i);
+		materialTexture = streamedMaterials->texture;
 	}
-	stbi_image_free(data);
-
-	// Texture 2
-	// ---------
-	glBindTexture(GL_TEXTURE_2D, texture[1]);
-	// Set texture wrapping options of currently bound texture object
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	// Load and generate texture
-	stbi_set_flip_vertically_on_load(true);
-	data = stbi_load("textures/awesomeface.png", &width, &height, &nrChannels, 0);
-	if (data)
+	bool materialsStreaming = streamedMaterials != nullptr;
+
+	// Floor cubes are all cobble
+	floorInstances.attachLayers(VAO, 6);
+	floorInstances.uploadLayers(std::vector<float>(floorTransforms.size(), (float)MATERIAL_COBBLE));
+
+	// Unbind VAO so other VAO calls dont accidentally modify the current VAO
+	glBindVertexArray(0);
+
+	// Set the material sampler to texture unit 0, the first use of each program
+	unsigned int readyPrograms = shaders.readyCount();
+	double finishStart = monotonicSeconds();
+	ourShader.use();
+	ourShader.setInt("materials", 0);
+	instancedShader.use();
+	instancedShader.setInt("materials", 0);
+	std::cout << (ourShader.loadedFromCache ? "Loaded shader binaries" : "Compiled shaders") << ", "
+		<< readyPrograms << "/" << shaders.size() << " ready at first use, waited "
+		<< (monotonicSeconds() - finishStart) * 1000.0 << " ms" << std::endl;
+
+	// Camera state shared by every program through a uniform block
+	CameraUniformBuffer cameraUbo;
+
+	// Voxel floor, one greedy mesh and one draw per chunk
+	// ---------------------------------------------------
+	ChunkWorld world;
+	world.setBlockLayer(BLOCK_COBBLE, MATERIAL_COBBLE);
+	world.fillFloor(worldSize, worldSize, -2, BLOCK_COBBLE);
+	ChunkMesh chunkScratch;
+	unsigned int meshedChunks = updateChunkMeshes(world, chunkScratch);
+	std::cout << "Meshed " << meshedChunks << " chunks for a " << worldSize << "x" << worldSize << " floor" << std::endl;
+
+	// Bounds for frustum culling, blocks are unit cubes centred on integer coordinates
+	// --------------------------------------------------------------------------------
+	AABBList chunkBounds;
+	for (Chunk* chunk : world.chunkList)
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		glm::vec3 min = glm::vec3(chunk->origin().x, chunk->origin().y, chunk->origin().z) - glm::vec3(0.5f);
+		chunkBounds.add(min, min + glm::vec3((float)CHUNK_SIZE));
 	}
-	else
+	AABBList cubeBounds;
+	for (unsigned int n = 0; n < gridSize; n++)
+		for (unsigned int i = 0; i < gridSize; i++)
+			cubeBounds.add(glm::vec3(i - 0.5f, -2.5f, n - 0.5f), glm::vec3(i + 0.5f, -1.5f, n + 0.5f));
+	std::vector<unsigned int> visible;
+
+	// Render queue tables, the render thread draws the packets the main thread submits
+	// --------------------------------------------------------------------------------
+	RenderQueue renderQueue;
+	const unsigned int shaderID = renderQueue.registerShader(&ourShader);
+	const unsigned int instancedShaderID = renderQueue.registerShader(&instancedShader);
+	const unsigned int textureSetID = renderQueue.registerTextureSet(GL_TEXTURE_2D_ARRAY, &materialTexture, 1);
+	const unsigned int cubeMeshID = renderQueue.registerMesh(VAO, cubeIndexCount);
+	const unsigned int instancedMeshID = renderQueue.registerMesh(VAO, cubeIndexCount, floorInstances.count());
+	std::vector<unsigned int> chunkMeshIDs;
+	for (Chunk* chunk : world.chunkList)
+		chunkMeshIDs.push_back(renderQueue.registerMesh(chunk->gpuMesh->VAO, chunk->gpuMesh->indexCount));
+	const float maxSortDistance = 2.0f * worldSize;
+
+	// Frames in flight between the threads, sized once so neither side allocates per frame.
+	// The per-cube path can submit every floor cube, at 24 bytes a packet with no matrix copy.
+	FrameRing<RenderFrame> frames;
+	for (unsigned int i = 0; i < frames.slotCount(); i++)
 	{
-		std::cout << "Failed to load texture" << std::endl;
+		frames.slot(i).drawList.reserve(gridSize * gridSize + (unsigned int)world.size());
+		frames.slot(i).arena.reserve(MOVED_MATRICES_PER_FRAME * sizeof(glm::mat4) + 64 * 1024);
 	}
-	stbi_image_free(data);
-
-	// Texture 3
-	// ---------
-	glBindTexture(GL_TEXTURE_2D, texture[2]);
-	// Set texture wrapping options of currently bound texture object
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	// Load and generate texture
-	stbi_set_flip_vertically_on_load(false);
-	data = stbi_load("textures/cobble.png", &width, &height, &nrChannels, 0);
-	if (data)
+	// Moved floor matrices not copied into a frame yet, [unsentFirst, unsentEnd)
+	unsigned int unsentFirst = 0, unsentEnd = 0;
+	FrameAllocations mainAllocations, renderAllocations;
+
+	// Setup above binds directly, start the state tracker from a clean slate
+	glState().invalidate();
+	if (sceneTarget)
+		sceneTarget->bind();
+
+	// Enable depth testing, reversed-Z clears to 0 and keeps the greater depth
+	// ------------------------------------------------------------------------
+	glState().setDepthTest(true);
+	if (reversedZ)
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		glExtensions().clipControlDepth(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+		glClearDepth(0.0);
+		glState().setDepthFunc(GL_GREATER);
 	}
-	else
+
+	// Frame time comparison between the render paths
+	FrameTimer frameTimer;
+	RenderMode lastRenderMode = renderMode;
+
+	// Scripted camera benchmark, starts once every material has streamed in
+	std::unique_ptr<CameraBenchmark> cameraBenchmark;
+	if (options.benchCamera)
 	{
-		std::cout << "Failed to load texture" << std::endl;
+		cameraBenchmark.reset(new CameraBenchmark(CameraPath::flyover((float)gridSize), options.frames));
+		while (streamedMaterials && streamedMaterials->pendingCount() > 0)
+		{
+			streamedMaterials->update(MATERIAL_COUNT);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
 	}
-	stbi_image_free(data);
+	const bool fixedFrameCount = options.headless || cameraBenchmark;
+	const int frameLimit = cameraBenchmark ? cameraBenchmark->totalFrames() : options.frames;
 
-	// Unbind VAO so other VAO calls dont accidentally modify the current VAO
-	glBindVertexArray(0);
+	// Profile the first frames of the run
+	if (options.profileFrames > 0)
+	{
+#ifdef UNO_PROFILER
+		PROFILE_THREAD_NAME("Main");
+		Profiler::get().beginCapture(options.profileFrames);
+#else
+		std::cout << "Profiler disabled at compile time, define UNO_PROFILER to capture frames" << std::endl;
+#endif
+	}
 
-	// Set uniforms of frag shader to texture locations
-	ourShader.use();
-	ourShader.setInt("texture1", 0);
-	ourShader.setInt("texture2", 1);
-	ourShader.setInt("texture3", 2);
+	// Render thread, owns the GL context from here until the main loop ends.
+	// It draws frame N while the main thread simulates N + 1, so a swap blocked
+	// on vsync no longer holds up input and simulation.
+	// -------------------------------------------------------------------------
+	auto renderLoop = [&]()
+	{
+		if (window)
+			glfwMakeContextCurrent(window);
+		else
+			headlessContext.makeCurrent();
+		PROFILE_THREAD_NAME("Render");
+		int viewportWidth = framebufferWidth, viewportHeight = framebufferHeight;
 
+		while (RenderFrame* frame = frames.beginRead())
+		{
+			renderAllocations.beginFrame();
+			const int frameNumber = frame->index;
+			const double frameSeconds = frame->frameSeconds;
+			const RenderMode frameMode = frame->renderMode;
+			if (cameraBenchmark)
+				cameraBenchmark->beginFrame(frameNumber);
+			glState().beginFrame();
+
+			// Stream in decoded materials, R queues them all again
+			if (streamedMaterials)
+			{
+				PROFILE_SCOPE("Streaming");
+				if (frame->reloadMaterials)
+				{
+					for (int i = 0; i < MATERIAL_COUNT; i++)
+						streamedMaterials->request(MATERIAL_SOURCES[i].path, MATERIAL_SOURCES[i].flipVertically, i);
+					materialStart = monotonicSeconds();
+					materialsStreaming = true;
+				}
+				streamedMaterials->update();
+				if (materialsStreaming && streamedMaterials->pendingCount() == 0)
+				{
+					std::cout << "Streamed materials in " << (monotonicSeconds() - materialStart) * 1000.0 << " ms, "
+						<< streamedMaterials->cacheHitCount() << " mip chains from cache" << std::endl;
+					materialsStreaming = false;
+				}
+			}
+			glState().setPolygonMode(frame->wireframe ? GL_LINE : GL_FILL);
 
-	// Enable depth testing
-	// --------------------
-	glEnable(GL_DEPTH_TEST);
+			// Follow window resizes
+			if (frame->viewportWidth != viewportWidth || frame->viewportHeight != viewportHeight)
+			{
+				viewportWidth = frame->viewportWidth;
+				viewportHeight = frame->viewportHeight;
+				if (sceneTarget)
+				{
+					sceneTarget->resize(viewportWidth, viewportHeight);
+					sceneTarget->bind();
+				}
+				else
+				{
+					glViewport(0, 0, viewportWidth, viewportHeight);
+				}
+			}
 
-	// Main render loop
-	// ----------------
-	while (!glfwWindowShouldClose(window))
+			// The camera block is only rewritten when the view or projection changed
+			if (frame->cameraChanged)
+				cameraUbo.update(frame->view, frame->projection, frame->eye);
+			if (frame->instanceCount > 0)
+				floorInstances.updateRange(frame->instanceMatrices, frame->instanceFirst, frame->instanceCount);
+			// Chunks are meshed during setup and the world is not edited at runtime, so
+			// this never rewrites meshes the main thread is reading
+			if (frameMode == RENDER_CHUNKS && updateChunkMeshes(world, chunkScratch) > 0)
+			{
+				for (unsigned int i = 0; i < world.size(); i++)
+					renderQueue.updateMesh(chunkMeshIDs[i], world.chunkList[i]->gpuMesh->VAO, world.chunkList[i]->gpuMesh->indexCount);
+			}
+
+			// Render
+			// ------
+			glClearColor(0.3f, 0.5f, 0.5f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			double submitStart = monotonicSeconds();
+			unsigned int drawCalls;
+			{
+				PROFILE_SCOPE("Submission");
+				PROFILE_GPU_SCOPE("Draw");
+				drawCalls = renderQueue.execute(frame->drawList, floorTransforms.matrices());
+			}
+			double submitTime = monotonicSeconds() - submitStart;
+			// Everything the slot holds has been issued, let the main thread refill it
+			frames.endRead();
+			cameraUbo.fence();
+			if (cameraBenchmark)
+				cameraBenchmark->endFrame();
+
+			// Report averaged frame times, restarting the window when the path changes
+			if (frameMode != lastRenderMode)
+			{
+				frameTimer.reset(monotonicSeconds());
+				lastRenderMode = frameMode;
+			}
+			if (frameTimer.frame(monotonicSeconds(), frameSeconds, submitTime, drawCalls, renderModeNames[frameMode]))
+				glState().printFrameCounters();
+
+			// Swap buffers
+			// ------------
+			{
+				PROFILE_SCOPE("Swap");
+				if (options.headless)
+				{
+					// Nothing throttles an offscreen target, wait for the GPU so frame times include its work
+					if (options.dumpFrames)
+					{
+						char path[512];
+						std::snprintf(path, sizeof(path), "%s/frame_%05d.ppm", options.dumpFrames, frameNumber);
+						sceneTarget->writePPM(path);
+					}
+					glFinish();
+				}
+				else
+				{
+					if (sceneTarget)
+						sceneTarget->present(viewportWidth, viewportHeight);
+					glfwSwapBuffers(window);
+				}
+			}
+#ifdef UNO_PROFILER
+			if (Profiler::get().endFrame())
+				Profiler::get().writeChromeTrace(options.profileOutput);
+#endif
+			renderAllocations.endFrame();
+		}
+
+		if (window)
+			glfwMakeContextCurrent(NULL);
+		else
+			headlessContext.release();
+	};
+	if (window)
+		glfwMakeContextCurrent(NULL);
+	else
+		headlessContext.release();
+	std::thread renderThread(renderLoop);
+
+	// Main loop: input, simulation and draw packets for the render thread
+	// -------------------------------------------------------------------
+	lastFrame = inputLog.start(monotonicSeconds());
+	timestep.start(lastFrame);
+	double runStart = monotonicSeconds();
+	int frameIndex = 0;
+	while (fixedFrameCount ? frameIndex < frameLimit && !(window && glfwWindowShouldClose(window)) : !glfwWindowShouldClose(window))
 	{
-		// Calculate frame time
-		// --------------------
-		float currentFrame = static_cast<float>(glfwGetTime());
+		// Calculate frame time, a replay ends with its last recorded frame
+		// ----------------------------------------------------------------
+		double currentFrame = inputLog.beginFrame(monotonicSeconds());
+		if (inputLog.finished())
+			break;
+		mainAllocations.beginFrame();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
-		// Apply jumping distance
-		if (isJumping == true)
+		// The scripted camera replaces input while benchmarking
+		if (cameraBenchmark)
 		{
-			currentJump = glfwGetTime();
-			cameraPos.y = sin((currentJump - firstJump) * 5) * 2;
-			if (currentJump - firstJump > 0.62831853071)
+			CameraKeyframe key = cameraBenchmark->cameraAt(frameIndex);
+			camera.teleport(key.position);
+			camera.setOrientation(key.yaw, key.pitch);
+			camera.setFov(key.fov);
+		}
+
+		// Simulate in fixed ticks
+		// -----------------------
+		unsigned int ticks = timestep.advance(currentFrame);
+		for (unsigned int tick = 0; tick < ticks; tick++)
+		{
+			PROFILE_SCOPE("Simulation");
+			simulationTime = timestep.simulationTime() - (ticks - 1 - tick) * timestep.tickSeconds();
+			camera.beginTick();
+			if (!cameraBenchmark)
 			{
-				cameraPos.y = 0.0f;
-				isJumping = false;
+				PROFILE_SCOPE("Input");
+				processInput(window, (float)timestep.tickSeconds());
 			}
+			updateJump();
 		}
 
+		// Take a free slot, the render thread is at most two frames behind
+		RenderFrame* frame;
+		{
+			PROFILE_SCOPE("Wait");
+			frame = frames.beginWrite();
+		}
+		if (!frame)
+			break;
+		frame->arena.reset();
+		frame->index = frameIndex;
+		frame->frameSeconds = deltaTime;
+		frame->renderMode = renderMode;
+		frame->wireframe = wireframe;
+		frame->reloadMaterials = reloadMaterials;
+		reloadMaterials = false;
+		frame->viewportWidth = camera.viewportWidth();
+		frame->viewportHeight = camera.viewportHeight();
+
+		// Render between the last two simulated states
+		frame->cameraChanged = camera.update((float)timestep.alpha());
+		if (frame->cameraChanged)
+		{
+			frame->view = camera.view();
+			frame->projection = camera.projection();
+			frame->eye = camera.eyePosition();
+		}
+		const glm::vec3& renderCameraPos = camera.eyePosition();
 
-		// Handle input
-		// ------------
-		processInput(window);
-			
-		// Render
-		// ------
-		glClearColor(0.3f, 0.5f, 0.5f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		// Recompose transforms that moved, the static floor costs nothing here.
+		// The moved range joins whatever earlier frames have not sent yet.
+		unsigned int firstMoved, movedCount;
+		if (floorTransforms.update(firstMoved, movedCount) > 0)
+		{
+			if (unsentEnd > unsentFirst)
+			{
+				unsentFirst = std::min(unsentFirst, firstMoved);
+				unsentEnd = std::max(unsentEnd, firstMoved + movedCount);
+			}
+			else
+			{
+				unsentFirst = firstMoved;
+				unsentEnd = firstMoved + movedCount;
+			}
+		}
+		frame->instanceCount = 0;
+		if (unsentEnd > unsentFirst)
+		{
+			unsigned int count = std::min(unsentEnd - unsentFirst, MOVED_MATRICES_PER_FRAME);
+			glm::mat4* moved = frame->arena.allocateArray<glm::mat4>(count);
+			std::copy(floorTransforms.matrices() + unsentFirst, floorTransforms.matrices() + unsentFirst + count, moved);
+			frame->instanceMatrices = moved;
+			frame->instanceFirst = unsentFirst;
+			frame->instanceCount = count;
+			unsentFirst += count;
+		}
 
-		// Draw container
-		// --------------
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture[0]);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, texture[1]);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, texture[2]);
-
-		// Activate shader
-		ourShader.use();
-
-		// Create transformations
-		glm::vec3 direction;
-		direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-		direction.y = sin(glm::radians(pitch));
-		direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-		cameraFront = glm::normalize(direction);
-
-		glm::mat4 view;
-		glm::mat4 projection = glm::mat4(1.0f);
-		projection = glm::perspective(glm::radians(fov), 800.0f / 600.0f, 0.1f, 100.0f);
-		view       = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-		// Pass tranformations to shader
-		int projectionLoc = glGetUniformLocation(ourShader.ID, "projection");
-		int viewLoc       = glGetUniformLocation(ourShader.ID, "view");
-		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-		glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-		// Render container
-		glBindVertexArray(VAO);
-		for (unsigned int n = 0; n < 20; n++)
+		// Submit draw packets for the active floor path
+		// ---------------------------------------------
+		const Frustum& frustum = camera.frustum();
+		DrawList& drawList = frame->drawList;
+		drawList.clear();
+		if (renderMode == RENDER_CHUNKS)
 		{
-			for (unsigned int i = 0; i < 20; i++)
+			// Chunk vertices are already in world space
 			{
-				glm::mat4 model = glm::mat4(1.0f);
-				model = glm::translate(model, glm::vec3((float)i, -2.0f, (float)n));
-				float angle = 20.0f * i;
-				model = glm::rotate(model, glm::radians(0.0f), glm::vec3(1.0f, 0.3f, 0.5f));
-				int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-				glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-				glDrawArrays(GL_TRIANGLES, 0, 36);
+				PROFILE_SCOPE("Culling");
+				cullAABBs(frustum, chunkBounds, visible);
 			}
+			for (unsigned int index : visible)
+			{
+				Chunk* chunk = world.chunkList[index];
+				if (chunk->gpuMesh->indexCount == 0)
+					continue;
+				glm::vec3 center = glm::vec3(chunk->origin().x, chunk->origin().y, chunk->origin().z) + glm::vec3(CHUNK_SIZE * 0.5f - 0.5f);
+				drawList.submit(SortKey::make(PASS_OPAQUE, shaderID, textureSetID, chunkMeshIDs[index],
+					SortKey::depth(glm::length(center - renderCameraPos), maxSortDistance)));
+			}
+		}
+		else if (renderMode == RENDER_INSTANCED)
+		{
+			drawList.submit(SortKey::make(PASS_OPAQUE, instancedShaderID, textureSetID, instancedMeshID, 0));
 		}
-		// Swap buffers, and poll IO events
-		// --------------------------------
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		else
+		{
+			{
+				PROFILE_SCOPE("Culling");
+				cullAABBs(frustum, cubeBounds, visible);
+			}
+			for (unsigned int index : visible)
+			{
+				drawList.submit(SortKey::make(PASS_OPAQUE, shaderID, textureSetID, cubeMeshID,
+					SortKey::depth(glm::length(floorTransforms.position(index) - renderCameraPos), maxSortDistance)), index);
+			}
+		}
+		{
+			PROFILE_SCOPE("Sort");
+			drawList.sort();
+		}
+		frames.endWrite();
+
+		// Poll IO events
+		// --------------
+		{
+			PROFILE_SCOPE("Poll");
+			if (window)
+				glfwPollEvents();
+			inputLog.dispatch(inputHandlers);
+		}
+		mainAllocations.endFrame();
+		frameIndex++;
 	}
-	
-	// Clear all allocated GLFW resources
-	// ----------------------------------
-	glfwTerminate();
+
+	// Let the render thread finish the frames in flight and take the context back
+	frames.close();
+	renderThread.join();
+	if (window)
+		glfwMakeContextCurrent(window);
+	else
+		headlessContext.makeCurrent();
+
+	if (cameraBenchmark)
+	{
+		cameraBenchmark->finish();
+		cameraBenchmark->write(options.benchOutput, gridSize, worldSize, renderModeNames[renderMode]);
+	}
+	if (options.headless)
+	{
+		double seconds = monotonicSeconds() - runStart;
+		std::cout << "Headless: " << frameIndex << " frames in " << seconds << " s ("
+			<< (seconds > 0.0 ? frameIndex / seconds : 0.0) << " fps)" << std::endl;
+	}
+	mainAllocations.print("main");
+	renderAllocations.print("render");
+	size_t arenaPeak = 0, arenaOverflow = 0;
+	for (unsigned int i = 0; i < frames.slotCount(); i++)
+	{
+		arenaPeak = std::max(arenaPeak, frames.slot(i).arena.highWater());
+		arenaOverflow += frames.slot(i).arena.overflowBytes();
+	}
+	if (arenaOverflow > 0)
+		std::cout << "ERROR::ARENA::OVERFLOW " << arenaOverflow << " bytes went to the heap, peak use " << arenaPeak << " of "
+			<< frames.slot(0).arena.size() << " bytes" << std::endl;
+	sceneTarget.reset();
+#ifdef UNO_PROFILER
+	Profiler::get().shutdown();
+#endif
+	if (inputLog.recording() || inputLog.replaying())
+	{
+		std::cout << (inputLog.recording() ? "Recorded " : "Replayed ") << inputLog.frameCount() << " frames, "
+			<< inputLog.eventCount() << " input events" << std::endl;
+		inputLog.close();
+	}
+
+	// GL objects above are destroyed first, then glfwSession clears all allocated GLFW resources
 	return 0;
 }
 
@@ -333,41 +856,87 @@ int main() {
 // ------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-	glViewport(0, 0, width, height);
+	// The render thread resizes the viewport with the next frame
+	camera.setViewport(width, height);
 }
 
-// Process key input, and react accordingly
-// ----------------------------------------
-void processInput(GLFWwindow* window)
+// Process key input for one simulation tick, and react accordingly
+// -----------------------------------------------------------------
+void processInput(GLFWwindow* window, float tickSeconds)
 {
-	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	if (keys.isDown(GLFW_KEY_ESCAPE) && window)
 		glfwSetWindowShouldClose(window, true);
 
-	glm::vec3 cameraRight = glm::normalize(glm::cross(cameraFront, cameraUp));
-
-	float cameraSpeed = 4.0f * deltaTime;
-	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
-		cameraSpeed = 6.5f * deltaTime;
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-		cameraPos += cameraSpeed * glm::normalize(glm::cross(cameraUp, cameraRight));
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-		cameraPos -= cameraSpeed * glm::normalize(glm::cross(cameraUp, cameraRight));
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-		cameraPos -= cameraRight * cameraSpeed;
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-		cameraPos += cameraRight * cameraSpeed;
+	const glm::vec3& cameraRight = camera.right();
+	glm::vec3 cameraForward = glm::normalize(glm::cross(camera.up(), cameraRight));
+
+	float cameraSpeed = 4.0f * tickSeconds;
+	if (keys.isDown(GLFW_KEY_LEFT_SHIFT))
+		cameraSpeed = 6.5f * tickSeconds;
+	if (keys.isDown(GLFW_KEY_W))
+		camera.move(cameraSpeed * cameraForward);
+	if (keys.isDown(GLFW_KEY_S))
+		camera.move(-cameraSpeed * cameraForward);
+	if (keys.isDown(GLFW_KEY_A))
+		camera.move(-cameraRight * cameraSpeed);
+	if (keys.isDown(GLFW_KEY_D))
+		camera.move(cameraRight * cameraSpeed);
 	
-	if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+	if (keys.isDown(GLFW_KEY_SPACE))
 	{
 		if (!isJumping)
 		{
-			firstJump = glfwGetTime();
+			firstJump = simulationTime;
 			isJumping = true;
 		}
 	}
 }
 
+// Apply jumping distance at the current simulation time
+// -----------------------------------------------------
+void updateJump()
+{
+	if (isJumping == true)
+	{
+		double jumpTime = simulationTime - firstJump;
+		glm::vec3 position = camera.position();
+		position.y = (float)(sin(jumpTime * 5) * 2);
+		if (jumpTime > 0.62831853071)
+		{
+			position.y = 0.0f;
+			isJumping = false;
+		}
+		camera.setPosition(position);
+	}
+}
+
+// Live GLFW input is logged while recording and ignored while replaying
+// ---------------------------------------------------------------------
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (inputLog.replaying())
+		return;
+	inputLog.recordCursor(monotonicSeconds(), xpos, ypos);
+	handleCursor(xpos, ypos);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	if (inputLog.replaying())
+		return;
+	inputLog.recordScroll(monotonicSeconds(), xoffset, yoffset);
+	handleScroll(xoffset, yoffset);
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (inputLog.replaying())
+		return;
+	inputLog.recordKey(monotonicSeconds(), key, scancode, action, mods);
+	handleKey(key, scancode, action, mods);
+}
+
+void handleCursor(double xpos, double ypos)
 {
 	if (firstMouse)
 	{
@@ -385,37 +954,27 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 	xoffset *= sensitivity;
 	yoffset *= sensitivity;
 
-	yaw   += xoffset;
-	pitch += yoffset;
-
-	if (pitch > 89.0f)
-		pitch = 89.0f;
-	if (pitch < -89.0f)
-		pitch = -89.0f;
+	camera.rotate(xoffset, yoffset);
 }
 
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+void handleScroll(double xoffset, double yoffset)
 {
-	fov -= (float)yoffset;
-	if (fov < 1.0f)
-		fov = 1.0f;
-	if (fov > 90.0f)
-		fov = 90.0f;
+	camera.setFov(camera.fov() - (float)yoffset);
 }
 
-void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+void handleKey(int key, int scancode, int action, int mods)
 {
+	keys.apply(key, action);
+	// Toggle wireframe, applied by the render thread
 	if (key == GLFW_KEY_F && action == GLFW_PRESS)
+		wireframe = !wireframe;
+	// Reload material textures in the background
+	if (key == GLFW_KEY_R && action == GLFW_PRESS)
+		reloadMaterials = true;
+	// Cycle between chunked, instanced and per-cube floor rendering
+	if (key == GLFW_KEY_I && action == GLFW_PRESS)
 	{
-		if (!togglePolygon)
-		{
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-			togglePolygon = true;
-		}
-		else
-		{
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-			togglePolygon = false;
-		}
+		renderMode = (RenderMode)((renderMode + 1) % 3);
+		std::cout << renderModeNames[renderMode] << " rendering" << std::endl;
 	}
 }
\ No newline at end of file
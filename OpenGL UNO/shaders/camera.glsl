@@ -0,0 +1,8 @@
+// Camera state shared by every program, bound at CAMERA_BLOCK_BINDING
+layout (std140) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	vec4 cameraPosition;
+};
\ No newline at end of file
@@ -1,13 +1,17 @@
 #version 330 core
 in vec2 TexCoord;
+flat in float Layer;
 
 out vec4 FragColor;
 
-uniform sampler2D texture1;
-uniform sampler2D texture2;
-uniform sampler2D texture3;
+// Every material is a layer of one array
+uniform sampler2DArray materials;
 
 void main()
 {
-    FragColor = texture(texture3, TexCoord);
+    FragColor = texture(materials, vec3(TexCoord, Layer));
+#ifdef ALPHA_TEST
+    if (FragColor.a < 0.5)
+        discard;
+#endif
 }
\ No newline at end of file
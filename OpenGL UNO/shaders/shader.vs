@@ -1,15 +1,28 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
+#ifdef INSTANCED
+layout (location = 2) in mat4 aInstanceModel;
+#endif
+layout (location = 6) in float aLayer;
 
 out vec2 TexCoord;
+flat out float Layer;
 
+#include "camera.glsl"
+
+#ifndef INSTANCED
 uniform mat4 model;
-uniform mat4 projection;
-uniform mat4 view;
+#endif
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos.x, aPos.y, aPos.z, 1.0);
+#ifdef INSTANCED
+	mat4 worldModel = aInstanceModel;
+#else
+	mat4 worldModel = model;
+#endif
+	gl_Position = viewProjection * worldModel * vec4(aPos.x, aPos.y, aPos.z, 1.0);
 	TexCoord = aTexCoord;
+	Layer = aLayer;
 }
\ No newline at end of file